@@ -2,6 +2,8 @@
 #define HASHMAP_H
 
 #include "vector.h"
+#include "arena.h"
+#include "string_hash.h"
 #include <string>
 #include <utility>
 using namespace std;
@@ -11,34 +13,88 @@ class Collection;
 
 template<typename K, typename V>
 class HashMap {
-private:
-    struct Node {
-        K key;
+public:
+    struct Entry {
+        K key;//менять через итератор нельзя, только value
         V value;
-        Node* next;
-        Node(const K& k, const V& v);
     };
+
+private:
+    //открытая адресация по схеме Robin Hood: элемент, ушедший дальше от своего слота,
+    //вытесняет более "богатый"; поиск останавливается, как только ушли дальше него
+    static const size_t EMPTY_SLOT = 0;
+    static const size_t OCCUPIED_BIT = size_t(1) << (sizeof(size_t) * 8 - 1);
+    static const size_t MIN_CAPACITY = 8;
     
-    Vector<Node*> buckets;//массив связныхсписков
-    size_t bucketCount;//размер таблицы
-    size_t itemCount;//колво элементов
-    const double loadFactor = 0.75;//для ресайза
+    size_t* hashes;//сохраненный хэш ключа с OCCUPIED_BIT, EMPTY_SLOT - свободно
+    Entry* entries;//сырая память, элемент создается только в занятом слоте
+    size_t capacity;//степень двойки или 0 до первой вставки
+    size_t itemCount;
+    Arena* arena;//слоты из арены запроса, nullptr - из кучи
     
     size_t customHash(const string& str) const;//хэш функция для стр
-    size_t getBucketIndex(const K& key) const;//индекс связного списка
-    void resize();
+    size_t hashOf(const K& key) const;
+    size_t probeDistance(size_t hash, size_t index) const;
+    size_t findIndex(const K& key) const;//capacity если ключа нет
+    bool needsGrow(size_t count) const;
+    void insertNew(size_t hash, Entry&& entry);//ключа в таблице точно нет
+    void rehash(size_t newCapacity);
+    void allocateSlots(size_t count, size_t*& newHashes, Entry*& newEntries);
+    void freeSlots(size_t* oldHashes, Entry* oldEntries);
+    void release();
+    size_t nextOccupied(size_t index) const;//первый занятый слот начиная с index
 
 public:
+    //обход занятых слотов на месте; вставка и удаление во время обхода его портят
+    class Iterator {
+    private:
+        HashMap* map;
+        size_t index;
+    public:
+        Iterator(HashMap* m, size_t i);
+        Entry& operator*() const;
+        Entry* operator->() const;
+        Iterator& operator++();
+        bool operator!=(const Iterator& other) const;
+    };
+    
+    class ConstIterator {
+    private:
+        const HashMap* map;
+        size_t index;
+    public:
+        ConstIterator(const HashMap* m, size_t i);
+        const Entry& operator*() const;
+        const Entry* operator->() const;
+        ConstIterator& operator++();
+        bool operator!=(const ConstIterator& other) const;
+    };
+    
+
     HashMap();
+    //таблица живет не дольше арены; копия такой таблицы уже в куче
+    explicit HashMap(Arena* arena);
     ~HashMap();
     HashMap(const HashMap& other);
     HashMap& operator=(const HashMap& other);
     HashMap(HashMap&& other) noexcept;
     HashMap& operator=(HashMap&& other) noexcept;
     void put(const K& key, const V& value);
+    void reserve(size_t count);//место под count элементов без перестроений
     bool get(const K& key, V& value) const;
+    V* lookup(const K& key);//указатель на хранимое значение для изменения на месте
     bool remove(const K& key);
     Vector<pair<K, V>> items() const;
+    template<typename F>
+    void forEach(F visit) const;//visit(key, value) для каждого элемента, без копирования
+    //для деления обхода между потоками: слоты [begin, end) из slotCount()
+    template<typename F>
+    void forEachInSlots(size_t begin, size_t end, F visit) const;
+    size_t slotCount() const;
+    Iterator begin();
+    Iterator end();
+    ConstIterator begin() const;
+    ConstIterator end() const;
     size_t size() const;
     void clear();
     bool contains(const K& key) const;
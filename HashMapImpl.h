@@ -2,52 +2,55 @@
 #define HASHMAPIMPL_H
 
 #include "HashMap.h"
+#include <new>
+#include <utility>
 
 template<typename K, typename V>
-HashMap<K, V>::Node::Node(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
+HashMap<K, V>::HashMap() : hashes(nullptr), entries(nullptr), capacity(0), itemCount(0), arena(nullptr) {}//память при первой вставке
 
-//констр копирования
 template<typename K, typename V>
-HashMap<K, V>::HashMap(const HashMap& other) 
-    : bucketCount(other.bucketCount), itemCount(0) {
-    //инициализация связных списков
-    for (size_t i = 0; i < bucketCount; i++) {
-        buckets.push_back(nullptr);//пустые
+HashMap<K, V>::HashMap(Arena* arena) : hashes(nullptr), entries(nullptr), capacity(0), itemCount(0), arena(arena) {}
+
+template<typename K, typename V>
+HashMap<K, V>::~HashMap() {
+    release();
+}
+
+//констр копирования: те же слоты, без пересчета хэшей
+template<typename K, typename V>
+HashMap<K, V>::HashMap(const HashMap& other)
+    : hashes(nullptr), entries(nullptr), capacity(0), itemCount(0), arena(nullptr) {
+    if (other.itemCount == 0) {
+        return;
     }
-    //коопируем все элементы из other
-    auto otherItems = other.items();
-    for (size_t i = 0; i < otherItems.size(); i++) {
-        put(otherItems[i].first, otherItems[i].second);
+    capacity = other.capacity;
+    allocateSlots(capacity, hashes, entries);
+    for (size_t i = 0; i < capacity; i++) {
+        hashes[i] = other.hashes[i];
+        if (hashes[i] != EMPTY_SLOT) {
+            new (&entries[i]) Entry(other.entries[i]);
+        }
     }
+    itemCount = other.itemCount;
 }
 //оператор присваивания
 template<typename K, typename V>
 HashMap<K, V>& HashMap<K, V>::operator=(const HashMap& other) {
     if (this != &other) {
-        clear();
-        bucketCount = other.bucketCount;//новый размер
-        itemCount = 0;
-        //и нициализация св списков
-        buckets.clear();
-        for (size_t i = 0; i < bucketCount; i++) {
-            buckets.push_back(nullptr);
-        }
-        //копируем
-        auto otherItems = other.items();
-        for (size_t i = 0; i < otherItems.size(); i++) {
-            put(otherItems[i].first, otherItems[i].second);
-        }
+        HashMap copy(other);
+        *this = std::move(copy);
     }
     return *this;
 }
 
 //конст перемещения
 template<typename K, typename V>
-HashMap<K, V>::HashMap(HashMap&& other) noexcept 
-    : buckets(std::move(other.buckets)), 
-      bucketCount(other.bucketCount), 
-      itemCount(other.itemCount) {
-    other.bucketCount = 0;
+HashMap<K, V>::HashMap(HashMap&& other) noexcept
+    : hashes(other.hashes), entries(other.entries),
+      capacity(other.capacity), itemCount(other.itemCount), arena(other.arena) {
+    other.hashes = nullptr;
+    other.entries = nullptr;
+    other.capacity = 0;
     other.itemCount = 0;
 }
 
@@ -55,12 +58,15 @@ HashMap<K, V>::HashMap(HashMap&& other) noexcept
 template<typename K, typename V>
 HashMap<K, V>& HashMap<K, V>::operator=(HashMap&& other) noexcept {
     if (this != &other) {
-        clear();
-        //перемещаем из other
-        buckets = std::move(other.buckets);
-        bucketCount = other.bucketCount;
+        release();
+        hashes = other.hashes;
+        entries = other.entries;
+        capacity = other.capacity;
         itemCount = other.itemCount;
-        other.bucketCount = 0;
+        arena = other.arena;
+        other.hashes = nullptr;
+        other.entries = nullptr;
+        other.capacity = 0;
         other.itemCount = 0;
     }
     return *this;
@@ -68,156 +74,327 @@ HashMap<K, V>& HashMap<K, V>::operator=(HashMap&& other) noexcept {
 
 template<typename K, typename V>
 size_t HashMap<K, V>::customHash(const string& str) const {
-    size_t hash = 5381;
-    const char* cStr = str.c_str();
-    for (size_t i = 0; i < str.length(); i++) {
-        hash = ((hash << 5) + hash) + cStr[i];
+    return static_cast<size_t>(StringHash::hash(str.data(), str.length()));
+}
+
+template<typename K, typename V>
+size_t HashMap<K, V>::hashOf(const K& key) const {
+    return customHash(key) | OCCUPIED_BIT;//старший бит не участвует в выборе слота
+}
+
+//на сколько слотов элемент ушел от своего идеального места
+template<typename K, typename V>
+size_t HashMap<K, V>::probeDistance(size_t hash, size_t index) const {
+    return (index - (hash & (capacity - 1))) & (capacity - 1);
+}
+
+template<typename K, typename V>
+size_t HashMap<K, V>::findIndex(const K& key) const {
+    if (itemCount == 0) {
+        return capacity;
+    }
+    size_t hash = hashOf(key);
+    size_t mask = capacity - 1;
+    size_t index = hash & mask;
+    for (size_t distance = 0; ; distance++) {
+        size_t stored = hashes[index];
+        if (stored == EMPTY_SLOT || probeDistance(stored, index) < distance) {
+            return capacity;//наш ключ стоял бы раньше
+        }
+        if (stored == hash && entries[index].key == key) {
+            return index;
+        }
+        index = (index + 1) & mask;
     }
-    return hash;
 }
 
+//заполнение не больше 7/8
 template<typename K, typename V>
-size_t HashMap<K, V>::getBucketIndex(const K& key) const {
-    if (bucketCount == 0) return 0;
-    return customHash(key) % bucketCount;
+bool HashMap<K, V>::needsGrow(size_t count) const {
+    return count * 8 > capacity * 7;
+}
+
+template<typename K, typename V>
+void HashMap<K, V>::insertNew(size_t hash, Entry&& entry) {
+    size_t mask = capacity - 1;
+    size_t index = hash & mask;
+    size_t distance = 0;
+    while (true) {
+        size_t stored = hashes[index];
+        if (stored == EMPTY_SLOT) {
+            new (&entries[index]) Entry(std::move(entry));
+            hashes[index] = hash;
+            return;
+        }
+        size_t storedDistance = probeDistance(stored, index);
+        if (storedDistance < distance) {//занимаем слот, дальше несем вытесненный элемент
+            std::swap(hashes[index], hash);
+            std::swap(entries[index], entry);
+            distance = storedDistance;
+        }
+        index = (index + 1) & mask;
+        distance++;
+    }
 }
 
 template<typename K, typename V>
-void HashMap<K, V>::resize() {
-    size_t newBucketCount = bucketCount * 2;
-    if (newBucketCount == 0) newBucketCount = 8;//нач размер
-    Vector<Node*> newBuckets;
-    for (size_t i = 0; i < newBucketCount; i++) {
-        newBuckets.push_back(nullptr);//пустые списки
+void HashMap<K, V>::rehash(size_t newCapacity) {
+    size_t* oldHashes = hashes;
+    Entry* oldEntries = entries;
+    size_t oldCapacity = capacity;
+
+    allocateSlots(newCapacity, hashes, entries);
+    for (size_t i = 0; i < newCapacity; i++) {
+        hashes[i] = EMPTY_SLOT;
     }
-    for (size_t i = 0; i < bucketCount; i++) {//хеш
-        Node* node = buckets[i];
-        while (node) {
-            Node* next = node->next;
-            size_t newIndex = customHash(node->key) % newBucketCount;
-            node->next = newBuckets[newIndex];//узел в начало цепочки нового списка
-            newBuckets[newIndex] = node;
-            node = next;
+    capacity = newCapacity;
+    for (size_t i = 0; i < oldCapacity; i++) {//хэши сохранены, ключи заново не хэшируем
+        if (oldHashes[i] != EMPTY_SLOT) {
+            insertNew(oldHashes[i], std::move(oldEntries[i]));
+            oldEntries[i].~Entry();
         }
     }
-    
-    buckets = newBuckets;
-    bucketCount = newBucketCount;
+    freeSlots(oldHashes, oldEntries);
 }
 
 template<typename K, typename V>
-HashMap<K, V>::HashMap() : bucketCount(8), itemCount(0) {
-    for (size_t i = 0; i < bucketCount; i++) {
-        buckets.push_back(nullptr);
+void HashMap<K, V>::allocateSlots(size_t count, size_t*& newHashes, Entry*& newEntries) {
+    if (arena) {
+        newHashes = static_cast<size_t*>(arena->allocate(sizeof(size_t) * count, alignof(size_t)));
+        newEntries = static_cast<Entry*>(arena->allocate(sizeof(Entry) * count, alignof(Entry)));
+        return;
     }
+    newHashes = new size_t[count];
+    newEntries = static_cast<Entry*>(::operator new(sizeof(Entry) * count));
 }
 
+//память арены отдается целиком в конце запроса
 template<typename K, typename V>
-HashMap<K, V>::~HashMap() {
-    clear();
+void HashMap<K, V>::freeSlots(size_t* oldHashes, Entry* oldEntries) {
+    if (arena) {
+        return;
+    }
+    delete[] oldHashes;
+    ::operator delete(oldEntries);
 }
 
 template<typename K, typename V>
-void HashMap<K, V>::put(const K& key, const V& value) {
-    if (bucketCount == 0 || (double)itemCount / bucketCount > loadFactor) {
-        resize();
-    }
-    
-    size_t index = getBucketIndex(key);
-    Node* node = buckets[index];
-    
-    while (node) {
-        if (node->key == key) {
-            node->value = value;
-            return;
+void HashMap<K, V>::release() {
+    for (size_t i = 0; i < capacity; i++) {
+        if (hashes[i] != EMPTY_SLOT) {
+            entries[i].~Entry();
         }
-        node = node->next;
     }
-    
-    Node* newNode = new Node(key, value);
-    newNode->next = buckets[index];
-    buckets[index] = newNode;
+    freeSlots(hashes, entries);
+    hashes = nullptr;
+    entries = nullptr;
+    capacity = 0;
+    itemCount = 0;
+}
+
+template<typename K, typename V>
+void HashMap<K, V>::reserve(size_t count) {
+    size_t newCapacity = capacity;
+    if (newCapacity == 0) {
+        newCapacity = MIN_CAPACITY;
+    }
+    while (count * 8 > newCapacity * 7) {
+        newCapacity *= 2;
+    }
+    if (newCapacity != capacity) {
+        rehash(newCapacity);
+    }
+}
+
+template<typename K, typename V>
+void HashMap<K, V>::put(const K& key, const V& value) {
+    size_t index = findIndex(key);
+    if (index != capacity) {
+        entries[index].value = value;
+        return;
+    }
+    if (capacity == 0) {
+        rehash(MIN_CAPACITY);
+    } else if (needsGrow(itemCount + 1)) {
+        rehash(capacity * 2);
+    }
+    insertNew(hashOf(key), Entry{key, value});
     itemCount++;
 }
 
 template<typename K, typename V>
 bool HashMap<K, V>::get(const K& key, V& value) const {
-    if (bucketCount == 0) return false;
-    
-    size_t index = getBucketIndex(key);
-    Node* node = buckets[index];
-    
-    while (node) {
-        if (node->key == key) {
-            value = node->value;
-            return true;
-        }
-        node = node->next;
+    size_t index = findIndex(key);
+    if (index == capacity) {
+        return false;
     }
-    return false;
+    value = entries[index].value;
+    return true;
+}
+
+template<typename K, typename V>
+V* HashMap<K, V>::lookup(const K& key) {
+    size_t index = findIndex(key);
+    return index == capacity ? nullptr : &entries[index].value;
 }
 
+//удаление со сдвигом назад: без надгробий, цепочки остаются короткими
 template<typename K, typename V>
 bool HashMap<K, V>::remove(const K& key) {
-    if (bucketCount == 0) return false;
-    
-    size_t index = getBucketIndex(key);
-    Node* node = buckets[index];
-    Node* prev = nullptr;
-    
-    while (node) {
-        if (node->key == key) {
-            if (prev) {//середина или конец
-                prev->next = node->next;
-            } else {//начало
-                buckets[index] = node->next;
-            }
-            delete node;
-            itemCount--;
-            return true;
-        }
-        prev = node;
-        node = node->next;
+    size_t index = findIndex(key);
+    if (index == capacity) {
+        return false;
     }
-    return false;
+    size_t mask = capacity - 1;
+    entries[index].~Entry();
+    size_t next = (index + 1) & mask;
+    while (hashes[next] != EMPTY_SLOT && probeDistance(hashes[next], next) > 0) {
+        new (&entries[index]) Entry(std::move(entries[next]));
+        entries[next].~Entry();
+        hashes[index] = hashes[next];
+        index = next;
+        next = (next + 1) & mask;
+    }
+    hashes[index] = EMPTY_SLOT;
+    itemCount--;
+    return true;
 }
 
 template<typename K, typename V>
 Vector<pair<K, V>> HashMap<K, V>::items() const {
     Vector<pair<K, V>> result;
-    for (size_t i = 0; i < bucketCount; i++) {
-        Node* node = buckets[i];
-        while (node) {
-            result.push_back(make_pair(node->key, node->value));
-            node = node->next;
+    for (size_t i = 0; i < capacity; i++) {
+        if (hashes[i] != EMPTY_SLOT) {
+            result.push_back(make_pair(entries[i].key, entries[i].value));
         }
     }
     return result;
 }
 
+template<typename K, typename V>
+template<typename F>
+void HashMap<K, V>::forEach(F visit) const {
+    for (size_t i = 0; i < capacity; i++) {
+        if (hashes[i] != EMPTY_SLOT) {
+            visit(static_cast<const K&>(entries[i].key), static_cast<const V&>(entries[i].value));
+        }
+    }
+}
+
+template<typename K, typename V>
+template<typename F>
+void HashMap<K, V>::forEachInSlots(size_t begin, size_t end, F visit) const {
+    if (end > capacity) {
+        end = capacity;
+    }
+    for (size_t i = begin; i < end; i++) {
+        if (hashes[i] != EMPTY_SLOT) {
+            visit(static_cast<const K&>(entries[i].key), static_cast<const V&>(entries[i].value));
+        }
+    }
+}
+
+template<typename K, typename V>
+size_t HashMap<K, V>::slotCount() const {
+    return capacity;
+}
+
+template<typename K, typename V>
+size_t HashMap<K, V>::nextOccupied(size_t index) const {
+    while (index < capacity && hashes[index] == EMPTY_SLOT) {
+        index++;
+    }
+    return index;
+}
+
+template<typename K, typename V>
+HashMap<K, V>::Iterator::Iterator(HashMap* m, size_t i) : map(m), index(i) {}
+
+template<typename K, typename V>
+typename HashMap<K, V>::Entry& HashMap<K, V>::Iterator::operator*() const {
+    return map->entries[index];
+}
+
+template<typename K, typename V>
+typename HashMap<K, V>::Entry* HashMap<K, V>::Iterator::operator->() const {
+    return &map->entries[index];
+}
+
+template<typename K, typename V>
+typename HashMap<K, V>::Iterator& HashMap<K, V>::Iterator::operator++() {
+    index = map->nextOccupied(index + 1);
+    return *this;
+}
+
+template<typename K, typename V>
+bool HashMap<K, V>::Iterator::operator!=(const Iterator& other) const {
+    return index != other.index;
+}
+
+template<typename K, typename V>
+HashMap<K, V>::ConstIterator::ConstIterator(const HashMap* m, size_t i) : map(m), index(i) {}
+
+template<typename K, typename V>
+const typename HashMap<K, V>::Entry& HashMap<K, V>::ConstIterator::operator*() const {
+    return map->entries[index];
+}
+
+template<typename K, typename V>
+const typename HashMap<K, V>::Entry* HashMap<K, V>::ConstIterator::operator->() const {
+    return &map->entries[index];
+}
+
+template<typename K, typename V>
+typename HashMap<K, V>::ConstIterator& HashMap<K, V>::ConstIterator::operator++() {
+    index = map->nextOccupied(index + 1);
+    return *this;
+}
+
+template<typename K, typename V>
+bool HashMap<K, V>::ConstIterator::operator!=(const ConstIterator& other) const {
+    return index != other.index;
+}
+
+template<typename K, typename V>
+typename HashMap<K, V>::Iterator HashMap<K, V>::begin() {
+    return Iterator(this, nextOccupied(0));
+}
+
+template<typename K, typename V>
+typename HashMap<K, V>::Iterator HashMap<K, V>::end() {
+    return Iterator(this, capacity);
+}
+
+template<typename K, typename V>
+typename HashMap<K, V>::ConstIterator HashMap<K, V>::begin() const {
+    return ConstIterator(this, nextOccupied(0));
+}
+
+template<typename K, typename V>
+typename HashMap<K, V>::ConstIterator HashMap<K, V>::end() const {
+    return ConstIterator(this, capacity);
+}
+
 template<typename K, typename V>
 size_t HashMap<K, V>::size() const {
     return itemCount;
 }
 
+//память таблицы остается для повторного заполнения
 template<typename K, typename V>
 void HashMap<K, V>::clear() {
-    for (size_t i = 0; i < bucketCount; i++) {
-        Node* node = buckets[i];
-        while (node) {
-            Node* next = node->next;
-            delete node;
-            node = next;
+    for (size_t i = 0; i < capacity; i++) {
+        if (hashes[i] != EMPTY_SLOT) {
+            entries[i].~Entry();
+            hashes[i] = EMPTY_SLOT;
         }
-        buckets[i] = nullptr;
     }
     itemCount = 0;
 }
 
 template<typename K, typename V>
 bool HashMap<K, V>::contains(const K& key) const {
-    V value;
-    return get(key, value);
+    return findIndex(key) != capacity;
 }
 
 #endif
@@ -3,33 +3,20 @@
 
 #include "HashMap.h"
 #include "vector.h"
+#include "json_tokenizer.h"
 #include <string>
 using namespace std;
 
+//плоский разбор поверх JsonTokenizer: вложенные объекты и массивы остаются исходным текстом
 class JsonParser {
-private:
-    string jsonStr;
-    size_t pos;
-    
-    void skipWhitespace();
-    string parsestring();
-    double parseNumber();
-    bool parseBoolean();
-    void parseNull();
-    Vector<string> parsestringArray(); 
-    HashMap<string, string> parseSingleObject();
-    bool isPotentialValidNumber(const std::string& str);
-    std::string getCurrentNumberString();
-    
 public:
-    JsonParser() : pos(0) {}
-    
-    HashMap<string, string> parseObject();
-    Vector<HashMap<string, string>> parseArray(const string& json);
+    //значение члена в том виде, в каком его хранит HashMap; false - такой член пропускается
+    static bool valueText(const JsonSpan& value, JsonToken type, string& out);
+
     HashMap<string, string> parse(const string& json);
-    string extractJsonValue(const string& json); 
-    
-    Vector<string> parseStringArray(const string& json);
+    HashMap<string, string> parse(const char* data, size_t length);
+    Vector<HashMap<string, string>> parseArray(const string& json);
+    Vector<HashMap<string, string>> parseArray(const char* data, size_t length);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -31,11 +31,12 @@ string NoSQLDBMS::executeCommand(int argc, char* argv[]) {
         Collection& coll = currentDb->getCollection("default");
         ConditionParser parser;
         QueryCondition condition = parser.parse(argv[3]);
-        Vector<Document> results = coll.find(condition);
+        if (!parser.getError().empty()) return "Error: " + parser.getError();
+        Vector<DocumentRef> results = coll.find(condition);
         
         string response = "Found " + to_string(results.size()) + " document(s):\n";
         for (size_t i = 0; i < results.size(); i++) {
-            response += results[i].to_json() + "\n";
+            response += results[i]->to_json() + "\n";
         }
         return response;
     }
@@ -44,6 +45,7 @@ string NoSQLDBMS::executeCommand(int argc, char* argv[]) {
         Collection& coll = currentDb->getCollection("default");
         ConditionParser parser;
         QueryCondition condition = parser.parse(argv[3]);
+        if (!parser.getError().empty()) return "Error: " + parser.getError();
         return coll.remove(condition);
     }
     else {
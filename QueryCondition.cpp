@@ -1,16 +1,20 @@
 #include "QueryCondition.h"
+#include "json_path.h"
 #include <cctype>
+#include <cstring>
+#include <algorithm>
 
 QueryCondition::QueryCondition()
-    : type(ConditionType::EQUAL), field(""), value("") {
+    : type(ConditionType::EQUAL), field(""), value(""), fieldId(-1), dictSlot(-1), code(0) {
 }
 
 QueryCondition::QueryCondition(ConditionType t, const string& f, const string& v) 
-    : type(t), field(f), value(v) {}
+    : type(t), field(f), value(v), fieldId(-1), dictSlot(-1), code(0) {}
 
 
 QueryCondition::QueryCondition(const QueryCondition& other)
-    : type(other.type), field(other.field), value(other.value) {
+    : type(other.type), field(other.field), value(other.value), param(other.param),
+      fieldId(other.fieldId), dictSlot(other.dictSlot), code(other.code), regex(other.regex) {
    
 
     for (size_t i = 0; i < other.inValues.size(); i++) {
@@ -21,6 +25,14 @@ QueryCondition::QueryCondition(const QueryCondition& other)
     for (size_t i = 0; i < other.subConditions.size(); i++) {
         subConditions.push_back(other.subConditions[i]);
     }
+    
+    for (size_t i = 0; i < other.path.size(); i++) {
+        path.push_back(other.path[i]);
+    }
+    
+    for (size_t i = 0; i < other.inCodes.size(); i++) {
+        inCodes.push_back(other.inCodes[i]);
+    }
 }
 
 
@@ -29,6 +41,7 @@ QueryCondition& QueryCondition::operator=(const QueryCondition& other) {
         type = other.type;
         field = other.field;
         value = other.value;
+        param = other.param;
         
 
         inValues.clear();
@@ -40,6 +53,20 @@ QueryCondition& QueryCondition::operator=(const QueryCondition& other) {
         for (size_t i = 0; i < other.subConditions.size(); i++) {
             subConditions.push_back(other.subConditions[i]);
         }
+        
+        path.clear();
+        for (size_t i = 0; i < other.path.size(); i++) {
+            path.push_back(other.path[i]);
+        }
+        
+        fieldId = other.fieldId;
+        dictSlot = other.dictSlot;
+        code = other.code;
+        inCodes.clear();
+        for (size_t i = 0; i < other.inCodes.size(); i++) {
+            inCodes.push_back(other.inCodes[i]);
+        }
+        regex = other.regex;
     }
     return *this;
 }
@@ -48,8 +75,15 @@ QueryCondition::QueryCondition(QueryCondition&& other) noexcept
     : type(other.type), 
       field(std::move(other.field)), 
       value(std::move(other.value)),
+      param(std::move(other.param)),
       inValues(std::move(other.inValues)),
-      subConditions(std::move(other.subConditions)) {
+      subConditions(std::move(other.subConditions)),
+      path(std::move(other.path)),
+      fieldId(other.fieldId),
+      dictSlot(other.dictSlot),
+      code(other.code),
+      inCodes(std::move(other.inCodes)),
+      regex(std::move(other.regex)) {
 }
 
 QueryCondition& QueryCondition::operator=(QueryCondition&& other) noexcept {
@@ -57,14 +91,131 @@ QueryCondition& QueryCondition::operator=(QueryCondition&& other) noexcept {
         type = other.type;
         field = std::move(other.field);
         value = std::move(other.value);
+        param = std::move(other.param);
         inValues = std::move(other.inValues);
         subConditions = std::move(other.subConditions);
+        path = std::move(other.path);
+        fieldId = other.fieldId;
+        dictSlot = other.dictSlot;
+        code = other.code;
+        inCodes = std::move(other.inCodes);
+        regex = std::move(other.regex);
     }
     return *this;
 }
 
+static const char* conditionTypeName(ConditionType type) {
+    switch (type) {
+        case ConditionType::EQUAL: return "eq";
+        case ConditionType::GREATER_THAN: return "gt";
+        case ConditionType::LESS_THAN: return "lt";
+        case ConditionType::LIKE: return "like";
+        case ConditionType::REGEX: return "regex";
+        case ConditionType::IN: return "in";
+        case ConditionType::AND: return "and";
+        case ConditionType::OR: return "or";
+    }
+    return "?";
+}
+
+//длина перед строкой, чтобы кавычки и скобки в значениях не давали коллизий
+static void appendKeyPart(string& out, const string& part) {
+    out += to_string(part.size());
+    out += ':';
+    out += part;
+}
+
+void QueryCondition::collectNormalizedParts(ConditionType parentType, std::vector<string>& parts) const {
+    if (type == parentType) {//вложенные $and в $and (и $or в $or) разворачиваем
+        for (size_t i = 0; i < subConditions.size(); i++) {
+            subConditions[i].collectNormalizedParts(parentType, parts);
+        }
+    } else {
+        parts.push_back(normalizedKey());
+    }
+}
+
+string QueryCondition::normalizedKey() const {
+    string key;
+    if (type == ConditionType::AND || type == ConditionType::OR) {
+        std::vector<string> parts;
+        for (size_t i = 0; i < subConditions.size(); i++) {
+            subConditions[i].collectNormalizedParts(type, parts);
+        }
+        if (parts.size() == 1) {
+            return parts[0];
+        }
+        //порядок подусловий на результат не влияет
+        sort(parts.begin(), parts.end());
+        parts.erase(unique(parts.begin(), parts.end()), parts.end());
+
+        key = conditionTypeName(type);
+        key += '(';
+        for (size_t i = 0; i < parts.size(); i++) {
+            if (i > 0) key += ',';
+            key += parts[i];
+        }
+        key += ')';
+        return key;
+    }
+
+    key = conditionTypeName(type);
+    key += '(';
+    appendKeyPart(key, field);
+    if (type == ConditionType::IN) {
+        std::vector<string> values;
+        for (size_t i = 0; i < inValues.size(); i++) {
+            values.push_back(inValues[i]);
+        }
+        sort(values.begin(), values.end());
+        values.erase(unique(values.begin(), values.end()), values.end());
+        for (size_t i = 0; i < values.size(); i++) {
+            appendKeyPart(key, values[i]);
+        }
+    } else if (!param.empty()) {
+        key += '$';
+        appendKeyPart(key, param);
+    } else {
+        appendKeyPart(key, value);
+    }
+    key += ')';
+    return key;
+}
+
+bool QueryCondition::hasParameters() const {
+    if (!param.empty()) return true;
+    for (size_t i = 0; i < subConditions.size(); i++) {
+        if (subConditions[i].hasParameters()) return true;
+    }
+    return false;
+}
+
+bool QueryCondition::bindParameters(const HashMap<string, string>& params, string& error) {
+    if (!param.empty()) {
+        if (!params.get(param, value)) {
+            error = "Missing parameter: " + param;
+            return false;
+        }
+        if (type == ConditionType::REGEX) {
+            string regexError;
+            regex = RegexCache::instance().get(value, regexError);
+            if (!regex) {
+                error = "Invalid $regex in parameter " + param + ": " + regexError;
+                return false;
+            }
+        }
+        param.clear();
+    }
+    for (size_t i = 0; i < subConditions.size(); i++) {
+        if (!subConditions[i].bindParameters(params, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void ConditionParser::skipWhitespace() {
-    while (pos < jsonStr.length() && isspace(jsonStr[pos])) {
+    while (pos < length && isspace(jsonStr[pos])) {
         pos++;
     }
 }
@@ -74,7 +225,7 @@ string ConditionParser::parsestring() {
     pos++;
     
     string result;
-    while (pos < jsonStr.length() && jsonStr[pos] != '"') {
+    while (pos < length && jsonStr[pos] != '"') {
         if (jsonStr[pos] == '\\') {
             pos++;
         }
@@ -87,20 +238,20 @@ string ConditionParser::parsestring() {
 
 double ConditionParser::parseNumber() {
     size_t start = pos;
-    while (pos < jsonStr.length() && 
+    while (pos < length && 
            (isdigit(jsonStr[pos]) || jsonStr[pos] == '.' || 
             jsonStr[pos] == '-' || jsonStr[pos] == '+')) {
         pos++;
     }
-    string numStr = jsonStr.substr(start, pos - start);
+    string numStr(jsonStr + start, pos - start);
     return stod(numStr);
 }
 
 bool ConditionParser::parseBoolean() {
-    if (pos + 4 <= jsonStr.length() && jsonStr.substr(pos, 4) == "true") {
+    if (pos + 4 <= length && strncmp(jsonStr + pos, "true", 4) == 0) {
         pos += 4;
         return true;
-    } else if (pos + 5 <= jsonStr.length() && jsonStr.substr(pos, 5) == "false") {
+    } else if (pos + 5 <= length && strncmp(jsonStr + pos, "false", 5) == 0) {
         pos += 5;
         return false;
     }
@@ -113,7 +264,7 @@ Vector<string> ConditionParser::parseArray() {
     if (jsonStr[pos] != '[') return result;
     pos++;
     
-    while (pos < jsonStr.length()) {
+    while (pos < length) {
         skipWhitespace();
         if (jsonStr[pos] == ']') {
             pos++;
@@ -138,6 +289,30 @@ Vector<string> ConditionParser::parseArray() {
     return result;
 }
 
+//значение для $eq/$gt/$lt: строка, число или {"$param":"name"}
+void ConditionParser::parseOperand(QueryCondition& condition) {
+    if (jsonStr[pos] == '"') {
+        condition.value = parsestring();
+    } else if (jsonStr[pos] == '{') {
+        pos++;
+        skipWhitespace();
+        string paramKey = parsestring();
+        skipWhitespace();
+        if (paramKey == "$param" && jsonStr[pos] == ':') {
+            pos++;
+            skipWhitespace();
+            condition.param = parsestring();
+        }
+        while (pos < length && jsonStr[pos] != '}') {
+            pos++;
+        }
+        if (pos < length) pos++;
+    } else {
+        double num = parseNumber();
+        condition.value = to_string(num);
+    }
+}
+
 QueryCondition ConditionParser::parseConditionObject() {
     skipWhitespace();
     
@@ -148,7 +323,7 @@ QueryCondition ConditionParser::parseConditionObject() {
     
     QueryCondition condition(ConditionType::AND);
     
-    while (pos < jsonStr.length()) {
+    while (pos < length) {
         skipWhitespace();
         if (jsonStr[pos] == '}') {
             pos++;
@@ -167,7 +342,7 @@ QueryCondition ConditionParser::parseConditionObject() {
                 pos++;
                 QueryCondition orCondition(ConditionType::OR);
                 
-                while (pos < jsonStr.length()) {
+                while (pos < length) {
                     skipWhitespace();
                     if (jsonStr[pos] == ']') {
                         pos++;
@@ -192,7 +367,7 @@ QueryCondition ConditionParser::parseConditionObject() {
                 pos++;
                 QueryCondition andCondition(ConditionType::AND);
                 
-                while (pos < jsonStr.length()) {
+                while (pos < length) {
                     skipWhitespace();
                     if (jsonStr[pos] == ']') {
                         pos++;
@@ -225,48 +400,54 @@ QueryCondition ConditionParser::parseConditionObject() {
                 skipWhitespace();
                 
                 QueryCondition subCondition(ConditionType::EQUAL, key, "");
+                if (key.find('.') != string::npos) {
+                    JsonPath::split(key, subCondition.path);
+                }
                 
                 if (operatorKey == "$eq") {
                     subCondition.type = ConditionType::EQUAL;
-                    if (jsonStr[pos] == '"') {
-                        subCondition.value = parsestring();
-                    } else {
-                        double num = parseNumber();
-                        subCondition.value = to_string(num);
-                    }
+                    parseOperand(subCondition);
                 }
                 else if (operatorKey == "$gt") {
                     subCondition.type = ConditionType::GREATER_THAN;
-                    if (jsonStr[pos] == '"') {
-                        subCondition.value = parsestring();
-                    } else {
-                        double num = parseNumber();
-                        subCondition.value = to_string(num);
-                    }
+                    parseOperand(subCondition);
                 }
                 else if (operatorKey == "$lt") {
                     subCondition.type = ConditionType::LESS_THAN;
-                    if (jsonStr[pos] == '"') {
-                        subCondition.value = parsestring();
-                    } else {
-                        double num = parseNumber();
-                        subCondition.value = to_string(num);
-                    }
+                    parseOperand(subCondition);
                 }
                 else if (operatorKey == "$like") {
                     subCondition.type = ConditionType::LIKE;
                     subCondition.value = parsestring();
                 }
+                else if (operatorKey == "$regex") {
+                    subCondition.type = ConditionType::REGEX;
+                    parseOperand(subCondition);
+                    if (subCondition.param.empty()) {//с параметром компилируется при execute
+                        string regexError;
+                        subCondition.regex = RegexCache::instance().get(subCondition.value, regexError);
+                        if (!subCondition.regex && error.empty()) {
+                            error = "Invalid $regex for " + key + ": " + regexError;
+                        }
+                    }
+                }
                 else if (operatorKey == "$in") {
                     subCondition.type = ConditionType::IN;
                     subCondition.inValues = parseArray();
                 }
+                else if (operatorKey == "$param") {//{"field":{"$param":"name"}} то же что $eq
+                    subCondition.type = ConditionType::EQUAL;
+                    subCondition.param = parsestring();
+                }
                 
                 condition.subConditions.push_back(subCondition);
                 skipWhitespace();
                 if (jsonStr[pos] == '}') pos++;
             } else {
                 QueryCondition subCondition(ConditionType::EQUAL, key, "");
+                if (key.find('.') != string::npos) {
+                    JsonPath::split(key, subCondition.path);
+                }
                 if (jsonStr[pos] == '"') {
                     subCondition.value = parsestring();
                 } else {
@@ -290,8 +471,10 @@ QueryCondition ConditionParser::parseConditionObject() {
 }
 
 QueryCondition ConditionParser::parse(const string& json) {
-    jsonStr = json;
+    jsonStr = json.c_str();
+    length = json.length();
     pos = 0;
+    error.clear();
     skipWhitespace();
     return parseConditionObject();
 }
@@ -3,6 +3,10 @@
 
 #include "vector.h"
 #include "HashMap.h"
+#include "regex_matcher.h"
+#include <vector>
+#include <cstdint>
+#include <memory>
 using namespace std;
 
 enum class ConditionType {
@@ -10,6 +14,7 @@ enum class ConditionType {
     GREATER_THAN,
     LESS_THAN,
     LIKE,
+    REGEX,
     IN,
     AND,
     OR
@@ -19,8 +24,16 @@ struct QueryCondition {
     ConditionType type;
     string field;
     string value;
+    string param;//имя параметра подготовленного запроса, значение подставляется при execute
     Vector<string> inValues;
     Vector<QueryCondition> subConditions;
+    Vector<string> path;//сегменты поля "proc.pid"; пусто, если в имени нет точки
+    //заполняются FieldTable::compile коллекции перед поиском
+    int fieldId;//номер поля в таблице имен, -1 если не найдено
+    int dictSlot;//словарь поля, -1 если значения не кодируются
+    uint32_t code;
+    Vector<uint32_t> inCodes;
+    shared_ptr<const RegexMatcher> regex;//для $regex; некорректный шаблон не проходит разбор
     QueryCondition();
     
     QueryCondition(ConditionType t, const string& f = "", const string& v = "");
@@ -30,22 +43,37 @@ struct QueryCondition {
     QueryCondition& operator=(QueryCondition&& other) noexcept;
     
     ~QueryCondition() = default;    
+
+    //каноничная запись условия: одинаковые по смыслу запросы дают один ключ
+    string normalizedKey() const;
+    //подставляет значения параметров; false и текст ошибки, если какого-то не хватает
+    //или подставленный шаблон $regex некорректен
+    bool bindParameters(const HashMap<string, string>& params, string& error);
+    bool hasParameters() const;
+
+private:
+    void collectNormalizedParts(ConditionType parentType, std::vector<string>& parts) const;
 };
 
 class ConditionParser {
 private:
-    string jsonStr;
+    const char* jsonStr;//входная строка не копируется
+    size_t length;
     size_t pos;
+    string error;//первая ошибка разбора, например некорректный $regex
    
     void skipWhitespace();
     string parsestring();
     double parseNumber();
     bool parseBoolean();
     Vector<string> parseArray();
+    void parseOperand(QueryCondition& condition);
     QueryCondition parseConditionObject();
     
 public:
+    ConditionParser() : jsonStr(""), length(0), pos(0) {}
     QueryCondition parse(const string& json);
+    const string& getError() const { return error; }//пусто, если условие разобрано
 };
 
 #endif
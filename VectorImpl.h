@@ -2,14 +2,45 @@
 #define VECTORIMPL_H
 
 #include "vector.h"
+#include <new>
+#include <utility>
+
+template<typename T>
+T* Vector<T>::allocate(size_t count) {
+    return static_cast<T*>(::operator new(sizeof(T) * count));//без конструкторов
+}
 
-//конст копирования
 template<typename T>
-Vector<T>::Vector(const Vector& other) 
-    : capacity(other.capacity), sizeVal(other.sizeVal) {
-    data = new T[capacity];
+void Vector<T>::deallocate(T* storage) {
+    ::operator delete(storage);
+}
+
+template<typename T>
+void Vector<T>::reallocate(size_t newCapacity) {
+    T* newData = newCapacity > 0 ? allocate(newCapacity) : nullptr;
     for (size_t i = 0; i < sizeVal; i++) {
-        data[i] = other.data[i];
+        new (&newData[i]) T(std::move(data[i]));
+        data[i].~T();
+    }
+    deallocate(data);
+    data = newData;
+    capacity = newCapacity;
+}
+
+template<typename T>
+size_t Vector<T>::grownCapacity() const {
+    return capacity == 0 ? 4 : capacity * 2;
+}
+
+//конст копирования
+template<typename T>
+Vector<T>::Vector(const Vector& other)
+    : data(nullptr), capacity(other.sizeVal), sizeVal(0) {
+    if (capacity > 0) {
+        data = allocate(capacity);
+    }
+    for (; sizeVal < other.sizeVal; sizeVal++) {
+        new (&data[sizeVal]) T(other.data[sizeVal]);
     }
 }
 
@@ -17,20 +48,15 @@ Vector<T>::Vector(const Vector& other)
 template<typename T>
 Vector<T>& Vector<T>::operator=(const Vector& other) {
     if (this != &other) {
-        delete[] data;
-        capacity = other.capacity;
-        sizeVal = other.sizeVal;
-        data = new T[capacity];
-        for (size_t i = 0; i < sizeVal; i++) {
-            data[i] = other.data[i];
-        }
+        Vector copy(other);
+        *this = std::move(copy);
     }
     return *this;
 }
 
 //конст перемещения
 template<typename T>
-Vector<T>::Vector(Vector&& other) noexcept 
+Vector<T>::Vector(Vector&& other) noexcept
     : data(other.data), capacity(other.capacity), sizeVal(other.sizeVal) {
     other.data = nullptr;
     other.capacity = 0;
@@ -41,7 +67,8 @@ Vector<T>::Vector(Vector&& other) noexcept
 template<typename T>
 Vector<T>& Vector<T>::operator=(Vector&& other) noexcept {
     if (this != &other) {
-        delete[] data;
+        clear();
+        deallocate(data);
         data = other.data;
         capacity = other.capacity;
         sizeVal = other.sizeVal;
@@ -57,49 +84,81 @@ Vector<T>::Vector() : data(nullptr), capacity(0), sizeVal(0) {}
 
 template<typename T>
 Vector<T>::~Vector() {
-    delete[] data;
+    clear();
+    deallocate(data);
 }
 
 template<typename T>
 void Vector<T>::push_back(const T& value) {
-    if (sizeVal >= capacity) {
-        size_t newCapacity = capacity == 0 ? 1 : capacity * 2;
-        T* newData = new T[newCapacity];
-        for (size_t i = 0; i < sizeVal; i++) {
-            newData[i] = std::move(data[i]);  // используем перемещение
-        }
-        delete[] data;
-        data = newData;
-        capacity = newCapacity;
-    }
-    data[sizeVal++] = value;
+    emplace_back(value);
 }
 
-// Новая перегрузка для перемещения
 template<typename T>
 void Vector<T>::push_back(T&& value) {
-    if (sizeVal >= capacity) {
-        size_t newCapacity = capacity == 0 ? 1 : capacity * 2;
-        T* newData = new T[newCapacity];
-        for (size_t i = 0; i < sizeVal; i++) {
-            newData[i] = std::move(data[i]);  // используем перемещение
-        }
-        delete[] data;
-        data = newData;
-        capacity = newCapacity;
+    emplace_back(std::move(value));
+}
+
+//при росте новый элемент создается до переноса старых: аргумент может ссылаться на элемент вектора
+template<typename T>
+template<typename... Args>
+T& Vector<T>::emplace_back(Args&&... args) {
+    if (sizeVal < capacity) {
+        new (&data[sizeVal]) T(std::forward<Args>(args)...);
+        return data[sizeVal++];
+    }
+    size_t newCapacity = grownCapacity();
+    T* newData = allocate(newCapacity);
+    try {
+        new (&newData[sizeVal]) T(std::forward<Args>(args)...);
+    } catch (...) {
+        deallocate(newData);
+        throw;
+    }
+    for (size_t i = 0; i < sizeVal; i++) {
+        new (&newData[i]) T(std::move(data[i]));
+        data[i].~T();
+    }
+    deallocate(data);
+    data = newData;
+    capacity = newCapacity;
+    return data[sizeVal++];
+}
+
+template<typename T>
+void Vector<T>::reserve(size_t newCapacity) {
+    if (newCapacity > capacity) {
+        reallocate(newCapacity);
+    }
+}
+
+template<typename T>
+void Vector<T>::erase(size_t first, size_t last) {
+    if (last > sizeVal) last = sizeVal;
+    if (first >= last) return;
+    size_t removed = last - first;
+    for (size_t i = last; i < sizeVal; i++) {
+        data[i - removed] = std::move(data[i]);
+    }
+    for (size_t i = sizeVal - removed; i < sizeVal; i++) {
+        data[i].~T();
+    }
+    sizeVal -= removed;
+}
+
+template<typename T>
+void Vector<T>::shrink_to_fit() {
+    if (sizeVal < capacity) {
+        reallocate(sizeVal);
     }
-    data[sizeVal++] = std::move(value);  // используем перемещение
 }
 
-// Новый метод pop_back
 template<typename T>
 void Vector<T>::pop_back() {
     if (sizeVal > 0) {
-        sizeVal--;
+        data[--sizeVal].~T();
     }
 }
 
-// Новый метод back
 template<typename T>
 T& Vector<T>::back() {
     return data[sizeVal - 1];
@@ -132,9 +191,9 @@ bool Vector<T>::empty() const {
 
 template<typename T>
 void Vector<T>::clear() {
-    delete[] data;
-    data = nullptr;
-    capacity = 0;
+    for (size_t i = 0; i < sizeVal; i++) {
+        data[i].~T();
+    }
     sizeVal = 0;
 }
 
@@ -142,29 +201,29 @@ template<typename T>
 Vector<T>::Iterator::Iterator(T* p) : ptr(p) {}
 
 template<typename T>
-T& Vector<T>::Iterator::operator*() { 
-    return *ptr; 
+T& Vector<T>::Iterator::operator*() {
+    return *ptr;
 }
 
 template<typename T>
-typename Vector<T>::Iterator& Vector<T>::Iterator::operator++() { 
-    ptr++; 
-    return *this; 
+typename Vector<T>::Iterator& Vector<T>::Iterator::operator++() {
+    ptr++;
+    return *this;
 }
 
 template<typename T>
-bool Vector<T>::Iterator::operator!=(const Iterator& other) { 
-    return ptr != other.ptr; 
+bool Vector<T>::Iterator::operator!=(const Iterator& other) {
+    return ptr != other.ptr;
 }
 
 template<typename T>
-typename Vector<T>::Iterator Vector<T>::begin() { 
-    return Iterator(data); 
+typename Vector<T>::Iterator Vector<T>::begin() {
+    return Iterator(data);
 }
 
 template<typename T>
-typename Vector<T>::Iterator Vector<T>::end() { 
-    return Iterator(data + sizeVal); 
+typename Vector<T>::Iterator Vector<T>::end() {
+    return Iterator(data + sizeVal);
 }
 
-#endif
\ No newline at end of file
+#endif
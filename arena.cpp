@@ -0,0 +1,86 @@
+#include "arena.h"
+#include <cstdint>
+
+static thread_local Arena* currentArena = nullptr;
+
+Arena::Arena() : head(nullptr), totalBytes(0) {}
+
+Arena::~Arena() {
+    while (head) {
+        Block* next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+}
+
+//блоки растут вдвое, крупный запрос получает блок под себя
+Arena::Block* Arena::newBlock(size_t minSize) {
+    size_t size = head ? head->size * 2 : FIRST_BLOCK_SIZE;
+    if (size > MAX_BLOCK_SIZE) {
+        size = MAX_BLOCK_SIZE;
+    }
+    if (size < minSize) {
+        size = minSize;
+    }
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = head;
+    block->size = size;
+    block->used = 0;
+    head = block;
+    return block;
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    Block* block = head;
+    if (block) {
+        uintptr_t start = reinterpret_cast<uintptr_t>(block->data() + block->used);
+        size_t padding = (alignment - start % alignment) % alignment;
+        if (block->used + padding + size <= block->size) {
+            block->used += padding + size;
+            totalBytes += size;
+            return reinterpret_cast<void*>(start + padding);
+        }
+    }
+    block = newBlock(size + alignment);
+    uintptr_t start = reinterpret_cast<uintptr_t>(block->data());
+    size_t padding = (alignment - start % alignment) % alignment;
+    block->used = padding + size;
+    totalBytes += size;
+    return reinterpret_cast<void*>(start + padding);
+}
+
+//первый блок остается, чтобы следующему запросу не ходить в кучу
+void Arena::reset() {
+    while (head && head->next) {
+        Block* next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+    if (head && head->size != FIRST_BLOCK_SIZE) {
+        ::operator delete(head);
+        head = nullptr;
+    }
+    if (head) {
+        head->used = 0;
+    }
+    totalBytes = 0;
+}
+
+Arena* Arena::current() {
+    return currentArena;
+}
+
+void Arena::setCurrent(Arena* arena) {
+    currentArena = arena;
+}
+
+ArenaScope::ArenaScope(Arena* arena) : arena(arena), previous(Arena::current()) {
+    Arena::setCurrent(arena);
+}
+
+ArenaScope::~ArenaScope() {
+    Arena::setCurrent(previous);
+    if (arena && arena != previous) {
+        arena->reset();
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <string>
+#include <new>
+using namespace std;
+
+//линейный распределитель на время одного запроса: память выдается сдвигом указателя
+//и освобождается целиком в reset(), отдельные освобождения ничего не делают
+class Arena {
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+        size_t used;
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    static const size_t FIRST_BLOCK_SIZE = 64 * 1024;//остается между запросами
+    static const size_t MAX_BLOCK_SIZE = 4 * 1024 * 1024;
+
+    Block* head;//текущий блок, дальше по next - заполненные
+    size_t totalBytes;
+
+    Block* newBlock(size_t minSize);
+
+public:
+    Arena();
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void reset();//все выданное становится недействительным
+    size_t bytesUsed() const { return totalBytes; }
+
+    static Arena* current();//арена запроса текущего потока или nullptr
+    static void setCurrent(Arena* arena);
+};
+
+//делает арену текущей для потока на время области видимости и очищает ее при выходе;
+//ArenaScope(nullptr) временно отключает арену, например для загрузки коллекции с диска
+class ArenaScope {
+private:
+    Arena* arena;
+    Arena* previous;
+
+public:
+    explicit ArenaScope(Arena* arena);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+//аллокатор для std-контейнеров; без арены работает через обычную кучу
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    Arena* arena;
+
+    ArenaAllocator() noexcept : arena(Arena::current()) {}
+    explicit ArenaAllocator(Arena* a) noexcept : arena(a) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        if (arena) {
+            return static_cast<T*>(arena->allocate(sizeof(T) * count, alignof(T)));
+        }
+        return static_cast<T*>(::operator new(sizeof(T) * count));
+    }
+
+    void deallocate(T* pointer, size_t) noexcept {
+        if (!arena) {
+            ::operator delete(pointer);
+        }
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+typedef basic_string<char, char_traits<char>, ArenaAllocator<char>> ArenaString;
+
+#endif
@@ -0,0 +1,173 @@
+#include "change_stream.h"
+#include "network_protocol.h"
+#include <sys/socket.h>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+ChangeStreams::ChangeStreams()
+    : subscriptionCount(0), nextSequence(1), epoch(static_cast<uint64_t>(std::time(nullptr))) {}
+
+ChangeStreams::~ChangeStreams() {
+    for (const auto& entry : streams) {
+        for (size_t j = 0; j < entry.value->subscribers.size(); j++) {
+            delete entry.value->subscribers[j];
+        }
+        delete entry.value;
+    }
+}
+
+string ChangeStreams::streamKey(const string& database, const string& collection) {
+    return database + "/" + collection;
+}
+
+string ChangeStreams::makeToken(uint64_t sequence) const {
+    return to_string(epoch) + "-" + to_string(sequence);
+}
+
+bool ChangeStreams::parseToken(const string& token, uint64_t& sequence) const {
+    size_t dash = token.find('-');
+    if (dash == string::npos || dash == 0 || dash + 1 == token.size()) {
+        return false;
+    }
+    char* end = nullptr;
+    uint64_t tokenEpoch = strtoull(token.c_str(), &end, 10);
+    if (end != token.c_str() + dash || tokenEpoch != epoch) {
+        return false;
+    }
+    sequence = strtoull(token.c_str() + dash + 1, &end, 10);
+    return end == token.c_str() + token.size() && sequence < nextSequence;
+}
+
+//без блокировки: медленного клиента отключаем, он вернется с токеном
+bool ChangeStreams::sendFrame(int clientSocket, const string& frame) {
+    ssize_t sent = send(clientSocket, frame.c_str(), frame.length(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    return sent == static_cast<ssize_t>(frame.length());
+}
+
+string ChangeStreams::eventFrame(uint64_t sequence, const Projection& projection, const Document& document) const {
+    Response event;
+    event.status = "change";
+    event.message = makeToken(sequence);
+    event.count = 1;
+    event.addRaw(document.to_json(projection));
+    return event.toJson();
+}
+
+void ChangeStreams::dropSubscription(Stream* stream, size_t index) {
+    Subscription* subscription = stream->subscribers[index];
+    stream->subscribers[index] = stream->subscribers.back();
+    stream->subscribers.pop_back();
+    subscriptionCount--;
+    delete subscription;
+}
+
+bool ChangeStreams::isWatched(const string& database, const string& collection) {
+    lock_guard<mutex> lock(streamsMutex);
+    return streams.contains(streamKey(database, collection));
+}
+
+void ChangeStreams::publish(const string& database, const string& collection, const DocumentRef& document) {
+    lock_guard<mutex> lock(streamsMutex);
+    Stream* stream = nullptr;
+    if (!streams.get(streamKey(database, collection), stream)) {
+        return;
+    }
+
+    ChangeEvent event;
+    event.sequence = nextSequence++;
+    event.document = document;
+    stream->events.push_back(event);
+    if (stream->events.size() > MAX_BUFFERED_EVENTS) {
+        stream->lastDropped = stream->events.front().sequence;
+        stream->events.pop_front();
+    }
+
+    size_t i = 0;
+    while (i < stream->subscribers.size()) {
+        Subscription* subscription = stream->subscribers[i];
+        if (!document->matchesCondition(subscription->condition)) {
+            i++;
+            continue;
+        }
+        if (sendFrame(subscription->clientSocket, eventFrame(event.sequence, subscription->projection, *document))) {
+            i++;
+            continue;
+        }
+        cerr << "[SERVER][WARN] Dropping slow subscriber on socket " << subscription->clientSocket << endl;
+        shutdown(subscription->clientSocket, SHUT_RDWR);//поток чтения соединения закроет сокет
+        dropSubscription(stream, i);
+    }
+}
+
+bool ChangeStreams::subscribe(int clientSocket, const string& database, const string& collection,
+                              const QueryCondition& condition, const Projection& projection,
+                              const string& resumeToken, string& error) {
+    lock_guard<mutex> lock(streamsMutex);
+    if (subscriptionCount >= MAX_SUBSCRIPTIONS) {
+        error = "Too many subscriptions";
+        return false;
+    }
+
+    string key = streamKey(database, collection);
+    Stream* stream = nullptr;
+    bool existed = streams.get(key, stream);
+    uint64_t resumeFrom = nextSequence - 1;
+    if (!resumeToken.empty()) {
+        if (!existed || !parseToken(resumeToken, resumeFrom) || resumeFrom < stream->lastDropped) {
+            error = "Resume token expired, run find to resynchronize";
+            return false;
+        }
+    }
+    if (!existed) {
+        stream = new Stream();
+        stream->lastDropped = nextSequence - 1;
+        streams.put(key, stream);
+    }
+
+    Subscription* subscription = new Subscription();
+    subscription->clientSocket = clientSocket;
+    subscription->condition = condition;
+    subscription->projection = projection;
+
+    Response ack;
+    ack.status = "success";
+    ack.message = "Subscribed to " + database + "." + collection;
+    ack.count = 0;
+    ack.addRaw("{\"resumeToken\":\"" + makeToken(resumeFrom) + "\"}");
+    bool sent = sendFrame(clientSocket, ack.toJson());
+
+    //пропущенные за время переподключения события, по порядку
+    for (size_t i = 0; sent && i < stream->events.size(); i++) {
+        const ChangeEvent& event = stream->events[i];
+        if (event.sequence <= resumeFrom || !event.document->matchesCondition(condition)) {
+            continue;
+        }
+        sent = sendFrame(clientSocket, eventFrame(event.sequence, projection, *event.document));
+    }
+    if (!sent) {
+        delete subscription;
+        error = "Failed to send subscription events";
+        shutdown(clientSocket, SHUT_RDWR);
+        return false;
+    }
+
+    stream->subscribers.push_back(subscription);
+    subscriptionCount++;
+    return true;
+}
+
+void ChangeStreams::unsubscribe(int clientSocket) {
+    lock_guard<mutex> lock(streamsMutex);
+    for (const auto& entry : streams) {
+        Stream* stream = entry.value;
+        size_t j = 0;
+        while (j < stream->subscribers.size()) {
+            if (stream->subscribers[j]->clientSocket == clientSocket) {
+                dropSubscription(stream, j);
+            } else {
+                j++;
+            }
+        }
+    }
+}
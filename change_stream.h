@@ -0,0 +1,70 @@
+#ifndef CHANGE_STREAM_H
+#define CHANGE_STREAM_H
+
+#include "document.h"
+#include "HashMap.h"
+#include "QueryCondition.h"
+#include "projection.h"
+#include "vector.h"
+#include <string>
+#include <deque>
+#include <mutex>
+#include <cstdint>
+using namespace std;
+
+//рассылка новых документов подписанным клиентам вместо опроса find.
+//событие: Response со status "change", message - токен возобновления, data[0] - документ
+class ChangeStreams {
+private:
+    static const size_t MAX_BUFFERED_EVENTS = 10000;//на коллекцию, для возобновления после переподключения
+    static const size_t MAX_SUBSCRIPTIONS = 1024;
+
+    struct Subscription {
+        int clientSocket;
+        QueryCondition condition;
+        Projection projection;
+    };
+
+    struct ChangeEvent {
+        uint64_t sequence;
+        DocumentRef document;
+    };
+
+    struct Stream {
+        deque<ChangeEvent> events;
+        uint64_t lastDropped;//события с номером не больше этого уже не повторить
+        Vector<Subscription*> subscribers;
+    };
+
+    HashMap<string, Stream*> streams;//"база/коллекция" -> поток изменений
+    size_t subscriptionCount;
+    uint64_t nextSequence;
+    uint64_t epoch;//токены прошлого запуска сервера не принимаются
+    mutex streamsMutex;
+
+    static string streamKey(const string& database, const string& collection);
+    string makeToken(uint64_t sequence) const;
+    bool parseToken(const string& token, uint64_t& sequence) const;
+    static bool sendFrame(int clientSocket, const string& frame);
+    string eventFrame(uint64_t sequence, const Projection& projection, const Document& document) const;
+    void dropSubscription(Stream* stream, size_t index);
+
+public:
+    ChangeStreams();
+    ~ChangeStreams();
+    ChangeStreams(const ChangeStreams&) = delete;
+    ChangeStreams& operator=(const ChangeStreams&) = delete;
+
+    //есть ли у коллекции поток изменений; вызывать под мьютексом базы, как и publish
+    bool isWatched(const string& database, const string& collection);
+    void publish(const string& database, const string& collection, const DocumentRef& document);
+
+    //отправляет подтверждение, события после resumeToken и регистрирует подписку;
+    //false и текст ошибки, если токен устарел или подписок слишком много
+    bool subscribe(int clientSocket, const string& database, const string& collection,
+                   const QueryCondition& condition, const Projection& projection,
+                   const string& resumeToken, string& error);
+    void unsubscribe(int clientSocket);//при закрытии соединения
+};
+
+#endif
@@ -17,9 +17,16 @@ void printHelp() {
     cout << "  --host <host>       Server hostname or IP (default: localhost)" << endl;
     cout << "  --port <port>       Server port (default: 8080)" << endl;
     cout << "  --database <db>     Database name (required)" << endl;
-    cout << "  --command <cmd>     Command to execute (insert|find|delete)" << endl;
-    cout << "  --collection <coll> Collection name" << endl;
-    cout << "  --data <json>       JSON data for insert or query for find/delete" << endl;
+    cout << "  --command <cmd>     Command to execute (insert|find|delete|update|prepare|execute|distinct|" << endl;
+    cout << "                      histogram|subscribe)" << endl;
+    cout << "  --collection <coll> Collection name (prepared query handle for execute)" << endl;
+    cout << "  --data <json>       JSON data for insert, query for find/delete/update/prepare," << endl;
+    cout << "                      parameters for execute" << endl;
+    cout << "  --update <json>     Modifiers for update ($set/$inc/$unset)" << endl;
+    cout << "  --projection <json> Fields returned by find/prepare, e.g. {\"proc.pid\":1}" << endl;
+    cout << "  --aggregate <json>  Spec for distinct: {\"field\":\"user\",\"precision\":14}" << endl;
+    cout << "                      or histogram: {\"field\":\"timestamp\",\"interval\":\"1m\",\"splitBy\":\"severity\"}" << endl;
+    cout << "  --resume <token>    Resume token printed by subscribe, continues after that event" << endl;
     cout << "  --help              Show this help message" << endl;
     cout << endl;
     cout << "Examples:" << endl;
@@ -33,6 +40,26 @@ void printHelp() {
     cout << "      --command find --collection users --data '{\"age\":{\"$gt\":25}}'" << endl;
     cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
     cout << "      --command delete --collection users --data '{\"name\":\"John\"}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command find --collection events --data '{\"proc.pid\":\"4242\"}' \\" << endl;
+    cout << "      --projection '{\"hostname\":1,\"proc.name\":1}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command find --collection events --data '{\"command\":{\"$regex\":\"curl.*\\\\|\\\\s*bash\"}}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command update --collection users --data '{\"name\":\"John\"}' \\" << endl;
+    cout << "      --update '{\"$inc\":{\"age\":1}}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command distinct --collection events --data '{\"severity\":\"high\"}' \\" << endl;
+    cout << "      --aggregate '{\"field\":\"user\",\"precision\":12}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command histogram --collection events --data '{}' \\" << endl;
+    cout << "      --aggregate '{\"interval\":\"1m\",\"splitBy\":\"severity\"}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command subscribe --collection events --data '{\"severity\":\"critical\"}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command prepare --collection users --data '{\"age\":{\"$gt\":{\"$param\":\"min\"}}}'" << endl;
+    cout << "    ./db_client --host localhost --port 8080 --database mydb \\" << endl;
+    cout << "      --command execute --collection q1 --data '{\"min\":25}'" << endl;
 }
 
 int main(int argc, char* argv[]) {
@@ -42,6 +69,10 @@ int main(int argc, char* argv[]) {
     string command;
     string collection;
     string data;
+    string modifiers;
+    string projection;
+    string aggregate;
+    string resumeToken;
     
     bool interactive = true;
 
@@ -59,6 +90,14 @@ int main(int argc, char* argv[]) {
             collection = argv[++i];
         } else if (strcmp(argv[i], "--data") == 0 && i + 1 < argc) {
             data = argv[++i];
+        } else if (strcmp(argv[i], "--update") == 0 && i + 1 < argc) {
+            modifiers = argv[++i];
+        } else if (strcmp(argv[i], "--projection") == 0 && i + 1 < argc) {
+            projection = argv[++i];
+        } else if (strcmp(argv[i], "--aggregate") == 0 && i + 1 < argc) {
+            aggregate = argv[++i];
+        } else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            resumeToken = argv[++i];
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             printHelp();
             return 0;
@@ -91,7 +130,8 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
-        Response resp = DBClient::executeSingleCommand(host, port, database, command, collection, data);
+        Response resp = DBClient::executeSingleCommand(host, port, database, command, collection, data, modifiers, projection,
+                                                       aggregate, resumeToken);
         
         cout << "Результат" << endl;
         cout << "Status: " << resp.status << endl;
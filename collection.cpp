@@ -1,14 +1,19 @@
 #include "collection.h"
-#include "JsonParser.h"
+#include "json_value.h"
 #include <fstream>
 #include <cstdio>
 #include <string>
+#include <thread>
+#include <atomic>
+#include "json_path.h"
 
-Collection::Collection(const string& collectionName) : name(collectionName) {
+Collection::Collection(const string& collectionName)
+    : name(collectionName), schema(make_shared<FieldTable>()), version(0), journalEntries(0) {
     loadFromDisk();
 }
 
 bool Collection::loadFromDisk() {
+    ArenaScope noArena(nullptr);//вся коллекция не должна копиться в арене запроса
     string filename = getFilename();
     std::ifstream file(filename.c_str());
     if (!file.is_open()) {
@@ -26,31 +31,74 @@ bool Collection::loadFromDisk() {
     file.close();
     
     if (jsonContent.empty()) {
+        replayJournal();
         return true;
     }
     
     //парсинг массива доков
-    JsonParser parser;
-    Vector<HashMap<string, string>> documentsArray = parser.parseArray(jsonContent);
+    JsonDocument parsed;
+    parsed.parse(jsonContent);
+    JsonValue documentsArray = parsed.root();
 
     documents.clear();
     
-    for (size_t i = 0; i < documentsArray.size(); i++) {//загрузка доков из массива
-        HashMap<string, string> docData = documentsArray[i];
+    for (size_t i = 0; documentsArray.isArray() && i < documentsArray.size(); i++) {//загрузка доков из массива
+        JsonValue docData = documentsArray[i];
+        if (!docData.isObject()) {
+            continue;
+        }
+        JsonValue storedId = docData.get("_id");
         string docId;
-        
-        if (!docData.get("_id", docId)) {
-            static int counter = 0;
+        if (storedId.valid()) {
+            docId = storedId.str();
+        } else {
+            static atomic<int> counter(0);
             docId = "doc_" + to_string(counter++);
         }
         
-        Document doc(docData, docId);//создаем документ объекты в хэш мап
-        documents.put(docId, doc);
+        documents.put(docId, make_shared<const Document>(docData, docId, schema));//создаем документ объекты в хэш мап
     }
     
+    replayJournal();
     return true;
 }
 
+//журнал: по строке на измененный документ, более поздняя строка главнее
+void Collection::replayJournal() {
+    std::ifstream journal(getJournalFilename().c_str());
+    if (!journal.is_open()) {
+        return;
+    }
+    
+    JsonDocument parsed;//буферы разбора переиспользуются от строки к строке
+    string line;
+    while (getline(journal, line)) {
+        if (line.empty() || !parsed.parse(line)) {
+            continue;
+        }
+        JsonValue storedId = parsed.root().get("_id");
+        if (!storedId.valid()) {
+            continue;
+        }
+        string docId = storedId.str();
+        documents.put(docId, make_shared<const Document>(parsed.root(), docId, schema));
+        journalEntries++;
+    }
+}
+
+bool Collection::appendToJournal(const Vector<DocumentRef>& changed) {
+    std::ofstream journal(getJournalFilename().c_str(), std::ios::app);
+    if (!journal.is_open()) {
+        return false;
+    }
+    for (size_t i = 0; i < changed.size(); i++) {
+        journal << changed[i]->to_json() << "\n";
+    }
+    journal.close();
+    journalEntries += changed.size();
+    return !journal.fail();
+}
+
 bool Collection::saveToDisk() {
     string filename = getFilename();
     std::ofstream file(filename.c_str());
@@ -59,19 +107,21 @@ bool Collection::saveToDisk() {
     }
     
     file << "[" << std::endl;
-    auto items = documents.items();
     bool first = true;
     
-    for (size_t i = 0; i < items.size(); i++) {
+    for (const auto& entry : documents) {
         if (!first) {
             file << "," << std::endl;
         }
-        string jsonStr = items[i].second.to_json();
-        file << " " << jsonStr.c_str();
+        file << " " << entry.value->to_json();
         first = false;
     }
     file << "]" << std::endl;
     file.close();
+    
+    //основной файл уже содержит все изменения из журнала
+    std::ofstream journal(getJournalFilename().c_str(), std::ios::trunc);
+    journalEntries = 0;
     return true;
 }
 
@@ -79,18 +129,27 @@ string Collection::getFilename() const {
     return name + ".json";
 }
 
-string Collection::insert(const string& jsonData) {
-    JsonParser parser;
-    HashMap<string, string> newDocData = parser.parse(jsonData);
+string Collection::getJournalFilename() const {
+    return name + ".journal";
+}
+
+string Collection::insert(const string& jsonData, DocumentRef* inserted) {
+    JsonDocument parsed;
+    parsed.parse(jsonData);
+    return insert(parsed.root(), inserted);
+}
 
-    static int counter = 0;
+string Collection::insert(const JsonValue& object, DocumentRef* inserted) {
+    static atomic<int> counter(0);//коллекции разных баз вставляют параллельно
     string docId = "doc_" + to_string(static_cast<int>(std::time(nullptr))) + 
                    "_" + to_string(std::rand() % 10000) + "_" + to_string(counter++);
 
-    newDocData.put("_id", docId);
-    
-    Document newDoc(newDocData, docId);
+    DocumentRef newDoc = make_shared<const Document>(object, docId, schema);
     documents.put(docId, newDoc);
+    if (inserted) {
+        *inserted = newDoc;
+    }
+    version++;
     
     if (saveToDisk()) {
         return string("Document inserted successfully.");
@@ -99,24 +158,119 @@ string Collection::insert(const string& jsonData) {
     }
 }
 
-Vector<Document> Collection::find(const QueryCondition& condition) {
-    Vector<Document> results;
-    auto items = documents.items();//все доки коллекции
-    
-    for (size_t i = 0; i < items.size(); i++) {
-        if (items[i].second.matchesCondition(condition)) {
-            results.push_back(items[i].second);//добавляем подходящие доки
+Vector<DocumentRef> Collection::find(const QueryCondition& condition) {
+    Vector<DocumentRef> results;
+    QueryCondition compiled = condition;
+    schema->compile(compiled);//номера полей и коды словарей
+    for (const auto& entry : documents) {//в выдачу идут ссылки, документы не копируются
+        if (entry.value->matchesCondition(compiled)) {
+            results.push_back(entry.value);
         }
     }
     return results;
 }
 
+HyperLogLog Collection::distinctCount(const QueryCondition& condition, const string& field,
+                                      int precision, size_t& matched) {
+    QueryCondition compiled = condition;
+    schema->compile(compiled);
+    Vector<string> path;
+    JsonPath::split(field, path);
+    //большие коллекции делим на диапазоны слотов, у каждого потока свой скетч, потом объединяем
+    const size_t MIN_DOCS_PER_PARTITION = 50000;
+    size_t partitions = documents.size() / MIN_DOCS_PER_PARTITION;
+    size_t hardware = thread::hardware_concurrency();
+    if (partitions > hardware) partitions = hardware;
+    if (partitions == 0) partitions = 1;
+
+    Vector<HyperLogLog> sketches;
+    Vector<size_t> counts;
+    sketches.reserve(partitions);
+    for (size_t p = 0; p < partitions; p++) {
+        sketches.emplace_back(precision);
+        counts.push_back(0);
+    }
+
+    size_t slots = documents.slotCount();
+    auto scan = [&](size_t part) {
+        string value;
+        documents.forEachInSlots(slots * part / partitions, slots * (part + 1) / partitions,
+                                 [&](const string&, const DocumentRef& doc) {
+            if (doc->matchesCondition(compiled)) {
+                counts[part]++;
+                if (doc->getPath(path, value)) {
+                    sketches[part].add(value);
+                }
+            }
+        });
+    };
+
+    Vector<thread*> workers;
+    for (size_t p = 1; p < partitions; p++) {
+        workers.push_back(new thread(scan, p));
+    }
+    scan(0);
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i]->join();
+        delete workers[i];
+    }
+
+    matched = counts[0];
+    for (size_t p = 1; p < partitions; p++) {
+        sketches[0].merge(sketches[p]);
+        matched += counts[p];
+    }
+    return sketches[0];
+}
+
+size_t Collection::histogram(const QueryCondition& condition, const string& field,
+                             const string& splitField, TimeHistogram& histogram) {
+    QueryCondition compiled = condition;
+    schema->compile(compiled);
+    Vector<string> path;
+    Vector<string> splitPath;
+    JsonPath::split(field, path);
+    if (!splitField.empty()) {
+        JsonPath::split(splitField, splitPath);
+    }
+
+    size_t matched = 0;
+    string timestamp;
+    string splitValue;
+    //документы читаются на месте, без копий
+    documents.forEach([&](const string&, const DocumentRef& doc) {
+        if (!doc->matchesCondition(compiled) || !doc->getPath(path, timestamp)) {
+            return;
+        }
+        matched++;
+        if (splitPath.empty()) {
+            histogram.add(timestamp, nullptr);
+            return;
+        }
+        if (!doc->getPath(splitPath, splitValue)) {
+            splitValue.clear();//поля нет - считаем под пустым ключом
+        }
+        histogram.add(timestamp, &splitValue);
+    });
+    return matched;
+}
+
 string Collection::remove(const QueryCondition& condition) {
-    Vector<Document> toRemove = find(condition);// находим что удалить
+    QueryCondition compiled = condition;
+    schema->compile(compiled);
+    Vector<string> toRemove;//удалять во время обхода нельзя, сначала собираем ключи
+    documents.forEach([&](const string& docId, const DocumentRef& doc) {
+        if (doc->matchesCondition(compiled)) {
+            toRemove.push_back(docId);
+        }
+    });
     size_t count = toRemove.size();
     
     for (size_t i = 0; i < toRemove.size(); i++) {
-        documents.remove(toRemove[i].getId());//удаляем из памяти
+        documents.remove(toRemove[i]);//удаляем из памяти
+    }
+    if (count > 0) {
+        version++;
     }
     
     if (count > 0) {
@@ -130,6 +284,46 @@ string Collection::remove(const QueryCondition& condition) {
     }
 }
 
+string Collection::update(const QueryCondition& condition, const UpdateSpec& spec) {
+    Vector<DocumentRef> changed;
+    size_t matched = 0;
+    QueryCondition compiled = condition;
+    schema->compile(compiled);
+    for (auto& entry : documents) {
+        if (!entry.value->matchesCondition(compiled)) {
+            continue;
+        }
+        matched++;
+        //копия при записи: старую версию могут еще держать выдачи и подписки, _id сохраняется
+        Document updated(*entry.value);
+        if (updated.applyUpdate(spec)) {
+            entry.value = make_shared<const Document>(std::move(updated));
+            changed.push_back(entry.value);
+        }
+    }
+    
+    if (matched == 0) {
+        return "No documents found matching the condition.";
+    }
+    if (changed.empty()) {
+        return string("0 document(s) updated successfully.");
+    }
+    version++;
+    
+    bool saved;
+    if (journalEntries + changed.size() > documents.size()) {
+        saved = saveToDisk();//журнал перерос коллекцию, переписываем файл целиком
+    } else {
+        saved = appendToJournal(changed);
+    }
+    
+    if (saved) {
+        return to_string(changed.size()) + string(" document(s) updated successfully.");
+    } else {
+        return string("Error: Failed to save changes to disk.");
+    }
+}
+
 size_t Collection::size() const {
     return documents.size();
 }
@@ -4,16 +4,28 @@
 #include "document.h"
 #include "HashMap.h"
 #include "QueryCondition.h"
+#include "update_spec.h"
+#include "field_table.h"
+#include "hyperloglog.h"
+#include "time_histogram.h"
 #include <fstream>
 #include <string>
+#include <cstdint>
+#include <memory>
 using namespace std;
 
 class Collection {
 private:
     string name;
-    HashMap<string, Document> documents;
+    HashMap<string, DocumentRef> documents;
+    shared_ptr<FieldTable> schema;//имена полей и словари, общие для всех документов коллекции
+    uint64_t version;//растет при каждом изменении коллекции
+    size_t journalEntries;//записей в журнале с последнего полного сохранения
     
     string getFilename() const;
+    string getJournalFilename() const;
+    bool appendToJournal(const Vector<DocumentRef>& changed);
+    void replayJournal();
 
 public:
     Collection(const string& collectionName);
@@ -23,10 +35,19 @@ public:
     Collection& operator=(Collection&& other) noexcept = default;
     bool loadFromDisk();
     bool saveToDisk();
-    string insert(const string& jsonData);
-    Vector<Document> find(const QueryCondition& condition);
+    string insert(const string& jsonData, DocumentRef* inserted = nullptr);//inserted - ссылка на новый документ
+    string insert(const JsonValue& object, DocumentRef* inserted = nullptr);//object уже разобран вызывающим
+    Vector<DocumentRef> find(const QueryCondition& condition);
     string remove(const QueryCondition& condition);
+    string update(const QueryCondition& condition, const UpdateSpec& spec);
+    //скетч значений поля (можно путь "proc.pid") у подходящих документов; matched - их число
+    HyperLogLog distinctCount(const QueryCondition& condition, const string& field,
+                              int precision, size_t& matched);
+    //считает подходящие документы по времени в field; splitField может быть пустым
+    size_t histogram(const QueryCondition& condition, const string& field, const string& splitField,
+                     TimeHistogram& histogram);
     size_t size() const;
+    uint64_t getVersion() const { return version; }
 };
 
 #endif
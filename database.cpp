@@ -7,9 +7,8 @@ Database::Database(const string& dbName) : name(dbName) {
 }
 
 Database::~Database() {
-    auto items = collections.items();
-    for (size_t i = 0; i < items.size(); i++) {
-        delete items[i].second;
+    for (const auto& entry : collections) {
+        delete entry.value;
     }
 }
 
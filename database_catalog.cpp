@@ -0,0 +1,33 @@
+#include "database_catalog.h"
+#include "string_hash.h"
+
+DatabaseCatalog::~DatabaseCatalog() {
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        for (const auto& entry : shards[i].entries) {
+            delete entry.value;
+        }
+    }
+}
+
+DatabaseCatalog::Shard& DatabaseCatalog::shardFor(const string& name) {
+    return shards[StringHash::hash(name.data(), name.length()) % SHARD_COUNT];
+}
+
+CatalogEntry* DatabaseCatalog::find(const string& name) {
+    Shard& shard = shardFor(name);
+    lock_guard<mutex> lock(shard.shardMutex);
+    CatalogEntry* entry = nullptr;
+    shard.entries.get(name, entry);
+    return entry;
+}
+
+CatalogEntry* DatabaseCatalog::getOrCreate(const string& name) {
+    Shard& shard = shardFor(name);
+    lock_guard<mutex> lock(shard.shardMutex);
+    CatalogEntry* entry = nullptr;
+    if (!shard.entries.get(name, entry)) {
+        entry = new CatalogEntry(name);//создание базы заденет только свой шард
+        shard.entries.put(name, entry);
+    }
+    return entry;
+}
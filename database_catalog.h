@@ -0,0 +1,47 @@
+#ifndef DATABASE_CATALOG_H
+#define DATABASE_CATALOG_H
+
+#include "database.h"
+#include "HashMap.h"
+#include <string>
+#include <mutex>
+using namespace std;
+
+//база и мьютекс, которым сервер упорядочивает работу с ней; живут до остановки сервера
+struct CatalogEntry {
+    Database* database;
+    mutex lock;
+
+    explicit CatalogEntry(const string& name) : database(new Database(name)) {}
+    ~CatalogEntry() { delete database; }
+    CatalogEntry(const CatalogEntry&) = delete;
+    CatalogEntry& operator=(const CatalogEntry&) = delete;
+};
+
+//базы по шардам со своими мьютексами: поиск держит только мьютекс своего шарда
+//и только на одно обращение к таблице, общей блокировки на горячем пути нет.
+//записи не удаляются, поэтому указатель на запись можно использовать без блокировки
+class DatabaseCatalog {
+private:
+    static const size_t SHARD_COUNT = 16;
+
+    struct Shard {
+        mutex shardMutex;
+        HashMap<string, CatalogEntry*> entries;
+    };
+
+    Shard shards[SHARD_COUNT];
+
+    Shard& shardFor(const string& name);
+
+public:
+    DatabaseCatalog() = default;
+    ~DatabaseCatalog();
+    DatabaseCatalog(const DatabaseCatalog&) = delete;
+    DatabaseCatalog& operator=(const DatabaseCatalog&) = delete;
+
+    CatalogEntry* find(const string& name);//nullptr если базы еще нет
+    CatalogEntry* getOrCreate(const string& name);
+};
+
+#endif
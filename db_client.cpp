@@ -7,6 +7,8 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <thread>
+#include <chrono>
 #include "JsonParser.h"
 #include "network_protocol.h"
 using std::cout;
@@ -14,6 +16,40 @@ using namespace std;
 
 static string normalizeJson(const string& json);
 
+//позиция сразу после объекта, начинающегося в start; complete - объект закрыт
+static size_t findJsonObjectEnd(const string& input, size_t start, bool* complete = nullptr) {
+    int braceCount = 0;
+    bool inString = false;
+    for (size_t i = start; i < input.length(); i++) {
+        char c = input[i];
+        if (inString) {
+            if (c == '\\') {
+                i++;
+            } else if (c == '"') {
+                inString = false;
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{') {
+            braceCount++;
+        } else if (c == '}') {
+            braceCount--;
+            if (braceCount == 0) {
+                if (complete) {
+                    *complete = true;
+                }
+                return i + 1;
+            }
+        }
+    }
+    if (complete) {
+        *complete = false;
+    }
+    return input.length();
+}
+
 CommandParser::ParsedCommand CommandParser::parse(const string& input) {
     ParsedCommand cmd;
     
@@ -56,13 +92,28 @@ CommandParser::ParsedCommand CommandParser::parse(const string& input) {
         string data = input.substr(dataStart);
         JsonParser parser;
         
+        //UPDATE <collection> <query> <modifiers>, DISTINCT/HISTOGRAM <collection> <query> <spec>,
+        //FIND/PREPARE <collection> <query> [projection]
+        if (cmd.operation == "UPDATE" || cmd.operation == "DISTINCT" || cmd.operation == "HISTOGRAM" ||
+            ((cmd.operation == "FIND" || cmd.operation == "PREPARE") && data[0] == '{')) {
+            size_t queryEnd = findJsonObjectEnd(data, 0);
+            cmd.query = data.substr(0, queryEnd);
+            size_t modifiersStart = queryEnd;
+            while (modifiersStart < data.length() && isspace(data[modifiersStart])) {
+                modifiersStart++;
+            }
+            cmd.data = data.substr(modifiersStart);
+            return cmd;
+        }
+        
         if (!data.empty() && data[0] == '{') {
             try {
                 HashMap<string, string> parsed = parser.parse(data);
                 if (parsed.size() > 0 || data == "{}") {
-                    if (cmd.operation == "INSERT") {
+                    if (cmd.operation == "INSERT" || cmd.operation == "EXECUTE") {
                         cmd.data = data;
-                    } else if (cmd.operation == "FIND" || cmd.operation == "DELETE") {
+                    } else if (cmd.operation == "FIND" || cmd.operation == "DELETE" ||
+                               cmd.operation == "PREPARE") {
                         cmd.query = data;
                     }
                     return cmd;
@@ -70,9 +121,10 @@ CommandParser::ParsedCommand CommandParser::parse(const string& input) {
             } catch (...) {
             }
         }
-        if (cmd.operation == "INSERT") {
+        if (cmd.operation == "INSERT" || cmd.operation == "EXECUTE") {
             cmd.data = data;
-        } else if (cmd.operation == "FIND" || cmd.operation == "DELETE") {
+        } else if (cmd.operation == "FIND" || cmd.operation == "DELETE" ||
+                   cmd.operation == "PREPARE") {
             cmd.query = data;
         }
     } 
@@ -128,6 +180,7 @@ void DBClient::disconnect() {
         close(socketFd);
         socketFd = -1;
     }
+    responses.reset();
 }
 
 bool DBClient::connect() {
@@ -167,84 +220,45 @@ Response DBClient::sendRequest(const Request& req) {
     if (setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv)) < 0) {
     }    
     char buffer[16384];
-    memset(buffer, 0, sizeof(buffer));
-    
-    int totalBytesRead = 0;
-    bool responseComplete = false;
-    string fullResponse;
-
-    while (!responseComplete && totalBytesRead < (int)sizeof(buffer) - 1) {
-        int bytesRead = recv(socketFd, buffer + totalBytesRead, sizeof(buffer) - 1 - totalBytesRead, 0);
+    string responseJson;
+    while (true) {//ответ может прийти несколькими частями, framer помнит уже просмотренное
+        JsonFrame frame = responses.next(responseJson);
+        if (frame == JsonFrame::MESSAGE) {
+            break;
+        }
+        if (frame == JsonFrame::INVALID) {
+            disconnect();
+            Response resp;
+            resp.status = "error";
+            resp.message = "Invalid JSON response from server";
+            return resp;
+        }
         
+        int bytesRead = recv(socketFd, buffer, sizeof(buffer), 0);
         if (bytesRead > 0) {
-            totalBytesRead += bytesRead;
-            buffer[totalBytesRead] = '\0';
-            
-            fullResponse = string(buffer);//полностью?
-            
-            if (!fullResponse.empty()) {
-                JsonParser parser;
-                try {
-                    HashMap<string, string> parsed = parser.parse(fullResponse);
-                    if (parsed.contains("status")) {
-                        responseComplete = true;
-                        break;
-                    }
-                } catch (...) {
-                }
-            }
+            responses.feed(buffer, bytesRead);
         }
         else if (bytesRead == 0) {
             disconnect();
-            break;
+            Response resp;
+            resp.status = "error";
+            resp.message = "No response from server";
+            return resp;
+        }
+        else if (errno == EINTR) {
+            continue;
         }
         else {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                if (totalBytesRead > 0) {
-                    JsonParser parser;
-                    try {
-                        HashMap<string, string> parsed = parser.parse(string(buffer, totalBytesRead));
-                        if (parsed.contains("status")) {
-                            responseComplete = true;
-                            break;
-                        } else {
-                            disconnect();
-                            Response resp;
-                            resp.status = "error";
-                            resp.message = "Server response timeout";
-                            return resp;
-                        }
-                    } catch (...) {
-                        disconnect();
-                        Response resp;
-                        resp.status = "error";
-                        resp.message = "Invalid JSON response from server";
-                        return resp;
-                    }
-                } else {
-                    disconnect();
-                    Response resp;
-                    resp.status = "error";
-                    resp.message = "Server response timeout";
-                    return resp;
-                }
-            } else {
-                disconnect();
-                Response resp;
-                resp.status = "error";
-                resp.message = "Failed to receive response from server";
-                return resp;
-            }
+            bool timedOut = errno == EAGAIN || errno == EWOULDBLOCK;
+            disconnect();
+            Response resp;
+            resp.status = "error";
+            resp.message = timedOut ? "Server response timeout" : "Failed to receive response from server";
+            return resp;
         }
-    }    
-    if (totalBytesRead == 0) {
-        Response resp;
-        resp.status = "error";
-        resp.message = "No response from server";
-        return resp;
     }
     try {
-        Response resp = Response::fromJson(string(buffer, totalBytesRead));
+        Response resp = Response::fromJson(responseJson);
         return resp;
     }
     catch (const exception& e) {
@@ -276,17 +290,18 @@ Response DBClient::insert(const string& collection, const Vector<string>& docume
             return resp;
         }
         
-        req.data.push_back(jsonStr);
+        req.addRaw(jsonStr);//уже проверен разбором выше
     }
     
     return sendRequest(req);
 }
 
-Response DBClient::find(const string& collection, const string& query) {    
+Response DBClient::find(const string& collection, const string& query, const string& projection) {    
     Request req;
     req.database = currentDatabase;
     req.operation = "find";
     req.collection = collection;
+    req.projection = normalizeJson(projection);
     
     JsonParser parser;
     string normalizedQuery = normalizeJson(query);
@@ -328,6 +343,140 @@ Response DBClient::remove(const string& collection, const string& query) {
     return sendRequest(req);
 }
 
+Response DBClient::prepare(const string& collection, const string& query, const string& projection) {
+    Request req;
+    req.database = currentDatabase;
+    req.operation = "prepare";
+    req.collection = collection;
+    req.query = normalizeJson(query);
+    req.projection = normalizeJson(projection);
+    
+    return sendRequest(req);
+}
+
+Response DBClient::execute(const string& handle, const string& params) {
+    Request req;
+    req.database = currentDatabase;
+    req.operation = "execute";
+    req.handle = handle;
+    
+    string normalizedParams = normalizeJson(params);
+    if (!normalizedParams.empty()) {
+        req.data.push_back(normalizedParams);
+    }
+    
+    return sendRequest(req);
+}
+
+Response DBClient::update(const string& collection, const string& query, const string& modifiers) {
+    Request req;
+    req.database = currentDatabase;
+    req.operation = "update";
+    req.collection = collection;
+    req.query = normalizeJson(query);
+    req.data.push_back(normalizeJson(modifiers));
+    
+    return sendRequest(req);
+}
+
+Response DBClient::distinctCount(const string& collection, const string& query, const string& spec) {
+    Request req;
+    req.database = currentDatabase;
+    req.operation = "distinctCount";
+    req.collection = collection;
+    req.query = normalizeJson(query);
+    req.data.push_back(normalizeJson(spec));
+    
+    return sendRequest(req);
+}
+
+Response DBClient::subscribe(const string& collection, const string& query, const string& projection,
+                             string& resumeToken, const function<void(const Response&)>& onChange) {
+    Request req;
+    req.database = currentDatabase;
+    req.operation = "subscribe";
+    req.collection = collection;
+    req.query = normalizeJson(query);
+    req.projection = normalizeJson(projection);
+    if (!resumeToken.empty()) {
+        req.data.push_back("{\"resumeToken\":\"" + resumeToken + "\"}");
+    }
+    
+    Response resp;
+    if (socketFd < 0) {
+        resp.status = "error";
+        resp.message = "Not connected to server";
+        return resp;
+    }
+    string jsonRequest = req.toJson();
+    if (send(socketFd, jsonRequest.c_str(), jsonRequest.length(), 0) < 0) {
+        disconnect();
+        resp.status = "error";
+        resp.message = "Failed to send request to server";
+        return resp;
+    }
+    
+    struct timeval tv;//события приходят когда угодно, ждем без таймаута
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    if (setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv)) < 0) {
+    }
+    
+    char buffer[16384];
+    bool acknowledged = false;
+    while (true) {
+        string message;
+        JsonFrame frame;
+        while ((frame = responses.next(message)) != JsonFrame::NEED_MORE) {
+            if (frame == JsonFrame::INVALID) {
+                disconnect();//после мусора границы событий потеряны
+                resp.status = "error";
+                resp.message = "Invalid JSON response from server";
+                return resp;
+            }
+            Response event = Response::fromJson(message);
+            if (!acknowledged) {
+                if (event.status != "success") {
+                    return event;//токен устарел или сервер отказал
+                }
+                acknowledged = true;
+                if (!event.data.empty()) {
+                    JsonParser parser;
+                    parser.parse(event.data[0]).get("resumeToken", resumeToken);
+                }
+                continue;
+            }
+            if (event.status == "change") {
+                resumeToken = event.message;
+                onChange(event);
+            }
+        }
+        
+        int bytesRead = recv(socketFd, buffer, sizeof(buffer), 0);
+        if (bytesRead > 0) {
+            responses.feed(buffer, bytesRead);
+        } else if (bytesRead < 0 && errno == EINTR) {
+            continue;
+        } else {
+            disconnect();
+            resp.status = "error";
+            resp.message = acknowledged ? "Connection closed" : "Server response timeout";
+            return resp;
+        }
+    }
+}
+
+Response DBClient::histogram(const string& collection, const string& query, const string& spec) {
+    Request req;
+    req.database = currentDatabase;
+    req.operation = "histogram";
+    req.collection = collection;
+    req.query = normalizeJson(query);
+    req.data.push_back(normalizeJson(spec));
+    
+    return sendRequest(req);
+}
+
 void DBClient::interactiveMode() {
     cout << "NoSQL Database" << endl;
     cout << "Сервер: " << host << ":" << port << endl;
@@ -335,8 +484,13 @@ void DBClient::interactiveMode() {
     cout << endl;
     cout << endl << "Доступные команды:" << endl;
     cout << "INSERT <collection> <json_data> - Вставка документа" << endl;
-    cout << "FIND <collection> <query> - Найти документы" << endl;
+    cout << "FIND <collection> <query> [projection] - Найти документы, проекция {\"поле.вложенное\":1}" << endl;
     cout << "DELETE <collection> <query> - Удалить документ" << endl;
+    cout << "PREPARE <collection> <query> - Подготовить запрос, значения {\"$param\":\"имя\"}" << endl;
+    cout << "EXECUTE <handle> <params> - Выполнить подготовленный запрос" << endl;
+    cout << "UPDATE <collection> <query> <modifiers> - Изменить документы ($set/$inc/$unset)" << endl;
+    cout << "DISTINCT <collection> <query> {\"field\":\"поле\",\"precision\":14} - Примерное число различных значений" << endl;
+    cout << "HISTOGRAM <collection> <query> {\"interval\":\"1m\",\"splitBy\":\"severity\"} - События по интервалам времени" << endl;
     cout << "HELP - Доступные команды" << endl;
     cout << "EXIT/QUIT - Выход" << endl;
     cout << endl;
@@ -358,8 +512,13 @@ void DBClient::interactiveMode() {
             if (line == "HELP") {
                 cout << endl << "Доступные команды:" << endl;
                 cout << "INSERT <collection> <json_data> - Вставка документа" << endl;
-                cout << "FIND <collection> <query> - Найти документы" << endl;
+                cout << "FIND <collection> <query> [projection] - Найти документы, проекция {\"поле.вложенное\":1}" << endl;
                 cout << "DELETE <collection> <query> - Удалить документ" << endl;
+                cout << "PREPARE <collection> <query> - Подготовить запрос, значения {\"$param\":\"имя\"}" << endl;
+                cout << "EXECUTE <handle> <params> - Выполнить подготовленный запрос" << endl;
+                cout << "UPDATE <collection> <query> <modifiers> - Изменить документы ($set/$inc/$unset)" << endl;
+                cout << "DISTINCT <collection> <query> {\"field\":\"поле\",\"precision\":14} - Примерное число различных значений" << endl;
+                cout << "HISTOGRAM <collection> <query> {\"interval\":\"1m\",\"splitBy\":\"severity\"} - События по интервалам времени" << endl;
                 cout << "HELP - Доступные команды" << endl;
                 cout << "EXIT or QUIT - Выход" << endl;
                 cout << currentDatabase << "> ";
@@ -454,7 +613,7 @@ void DBClient::interactiveMode() {
                 }
             }
             
-            resp = find(cmd.collection, normalizedQuery);
+            resp = find(cmd.collection, normalizedQuery, cmd.data);
             
         } else if (cmd.operation == "DELETE") {
             if (cmd.collection.empty() || cmd.query.empty()) {
@@ -473,6 +632,41 @@ void DBClient::interactiveMode() {
             
             resp = remove(cmd.collection, normalizedQuery);
             
+        } else if (cmd.operation == "PREPARE") {
+            if (cmd.collection.empty() || cmd.query.empty()) {
+                cout << "Error: PREPARE requires collection and query" << endl;
+                continue;
+            }
+            resp = prepare(cmd.collection, cmd.query, cmd.data);
+            
+        } else if (cmd.operation == "UPDATE") {
+            if (cmd.collection.empty() || cmd.query.empty() || cmd.data.empty()) {
+                cout << "Error: UPDATE requires collection, query and modifiers" << endl;
+                continue;
+            }
+            resp = update(cmd.collection, cmd.query, cmd.data);
+            
+        } else if (cmd.operation == "DISTINCT") {
+            if (cmd.collection.empty() || cmd.query.empty() || cmd.data.empty()) {
+                cout << "Error: DISTINCT requires collection, query and field spec" << endl;
+                continue;
+            }
+            resp = distinctCount(cmd.collection, cmd.query, cmd.data);
+            
+        } else if (cmd.operation == "HISTOGRAM") {
+            if (cmd.collection.empty() || cmd.query.empty()) {
+                cout << "Error: HISTOGRAM requires collection and query" << endl;
+                continue;
+            }
+            resp = histogram(cmd.collection, cmd.query, cmd.data.empty() ? "{}" : cmd.data);
+            
+        } else if (cmd.operation == "EXECUTE") {
+            if (cmd.collection.empty()) {
+                cout << "Error: EXECUTE requires handle" << endl;
+                continue;
+            }
+            resp = execute(cmd.collection, cmd.data);
+            
         } else {
             cout << "Error: Unknown operation '" << cmd.operation << "'" << endl;
             continue;
@@ -494,7 +688,9 @@ void DBClient::interactiveMode() {
 
 Response DBClient::executeSingleCommand(const string& host, int port, 
                                         const string& db, const string& command,
-                                        const string& collection, const string& data) {
+                                        const string& collection, const string& data,
+                                        const string& modifiers, const string& projection,
+                                        const string& aggregate, const string& resumeToken) {
     DBClient client(host, port, db);
     if (!client.connect()) {
         Response resp;
@@ -513,6 +709,46 @@ Response DBClient::executeSingleCommand(const string& host, int port,
     } else if (command == "delete") {
         op = "delete";
         query = data;
+    } else if (command == "prepare") {
+        return client.prepare(collection, data, projection);
+    } else if (command == "execute") {
+        return client.execute(collection, data);
+    } else if (command == "distinct") {
+        if (aggregate.empty()) {
+            Response resp;
+            resp.status = "error";
+            resp.message = "Distinct requires --aggregate '{\"field\":\"<name>\"}'";
+            return resp;
+        }
+        return client.distinctCount(collection, data.empty() ? "{}" : data, aggregate);
+    } else if (command == "subscribe") {
+        string token = resumeToken;
+        auto printChange = [](const Response& event) {
+            for (size_t i = 0; i < event.data.size(); i++) {
+                cout << "[" << event.message << "] " << event.data[i] << endl;
+            }
+        };
+        while (true) {
+            Response resp = client.subscribe(collection, data.empty() ? "{}" : data, projection, token, printChange);
+            if (resp.message != "Connection closed") {
+                return resp;//отказ сервера, переподключение не поможет
+            }
+            //сервер перезапускается или отключил медленного клиента: продолжаем с токена
+            cerr << "Connection lost, resuming from " << token << endl;
+            do {
+                this_thread::sleep_for(chrono::seconds(1));
+            } while (!client.connect());
+        }
+    } else if (command == "histogram") {
+        return client.histogram(collection, data.empty() ? "{}" : data, aggregate.empty() ? "{}" : aggregate);
+    } else if (command == "update") {
+        if (modifiers.empty()) {
+            Response resp;
+            resp.status = "error";
+            resp.message = "Update requires --update <modifiers>";
+            return resp;
+        }
+        return client.update(collection, data, modifiers);
     } else {
         Response resp;
         resp.status = "error";
@@ -544,7 +780,7 @@ Response DBClient::executeSingleCommand(const string& host, int port,
             } catch (const exception& e) {
             }
         }
-        return client.find(collection, normalizedData);
+        return client.find(collection, normalizedData, projection);
     } else {
         if (!normalizedData.empty() && normalizedData[0] == '{') {
             try {
@@ -2,8 +2,10 @@
 #define DB_CLIENT_H
 
 #include "network_protocol.h"
+#include "json_framer.h"
 #include "vector.h"
 #include <string>
+#include <functional>
 
 using namespace std;
 
@@ -25,7 +27,7 @@ private:
     int port;
     string currentDatabase;
     int socketFd;
-    
+    JsonFramer responses;//хвост следующего ответа или события между вызовами recv
     
 public:
     DBClient(const string& host, int port, const string& db);
@@ -38,13 +40,23 @@ public:
     void reconnectIfNeeded();
     
     Response insert(const string& collection, const Vector<string>& documents);
-    Response find(const string& collection, const string& query);
+    Response find(const string& collection, const string& query, const string& projection = "");
     Response remove(const string& collection, const string& query);
+    Response prepare(const string& collection, const string& query, const string& projection = "");
+    Response execute(const string& handle, const string& params);
+    Response update(const string& collection, const string& query, const string& modifiers);
+    Response distinctCount(const string& collection, const string& query, const string& spec);
+    Response histogram(const string& collection, const string& query, const string& spec);
+    //ждет новые подходящие документы, пока соединение живо; resumeToken обновляется с каждым событием
+    Response subscribe(const string& collection, const string& query, const string& projection,
+                       string& resumeToken, const function<void(const Response&)>& onChange);
     Response sendRequest(const Request& req);
     void interactiveMode();
     static Response executeSingleCommand(const string& host, int port, 
                                         const string& db, const string& command,
-                                        const string& collection, const string& data);
+                                        const string& collection, const string& data,
+                                        const string& modifiers = "", const string& projection = "",
+                                        const string& aggregate = "", const string& resumeToken = "");
 };
 
 #endif
\ No newline at end of file
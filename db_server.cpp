@@ -1,5 +1,9 @@
 #include "db_server.h"
 #include "QueryCondition.h"
+#include "update_spec.h"
+#include "json_framer.h"
+#include "json_writer.h"
+#include "json_value.h"
 #include <sys/socket.h>
 #include "HashMap.h"
 #include <netinet/in.h>
@@ -10,25 +14,20 @@
 #include <memory>
 #include <mutex>
 #include <chrono>
+#include <cstdio>
 #include <arpa/inet.h>
 #include "JsonParser.h"
 #include "vector.h"
 
 using namespace std;
 
-ConnectionManager::ConnectionManager() : running(false), serverSocket(-1) {
+ConnectionManager::ConnectionManager() : running(false), serverSocket(-1), nextPreparedId(1) {
 }
 
 ConnectionManager::~ConnectionManager() {
     stop();
-    auto dbItems = databases.items();
-    for (size_t i = 0; i < dbItems.size(); i++) {
-        delete dbItems[i].second;
-    }
-    
-    auto mutexItems = dbMutexes.items();
-    for (size_t i = 0; i < mutexItems.size(); i++) {
-        delete mutexItems[i].second;//очистка мьютексов
+    for (const auto& entry : preparedQueries) {
+        delete entry.value;
     }
 }
 
@@ -121,29 +120,34 @@ bool ConnectionManager::start(int port, int numWorkers) {
             
             thread([this, clientSocket, clientIP]() {//для каждого кл свой поток, + несколько запросов        
                 char buffer[8192];
+                JsonFramer framer;//запрос может прийти несколькими частями или вместе со следующим
+                string requestStr;
                 while (running) {
-                    memset(buffer, 0, sizeof(buffer));//очистка
-                    int bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+                    int bytesRead = recv(clientSocket, buffer, sizeof(buffer), 0);
                     
                     if (bytesRead > 0) {
-                        buffer[bytesRead] = '\0';
                         cout << "[SERVER] Received " << bytesRead << " bytes from client " << clientSocket << endl;
-                        string requestStr(buffer);
-                        if (!isValidJsonRequest(requestStr)) {
-                            cerr << "[SERVER][ERROR] Invalid JSON request from client " << clientSocket << endl;
-                            Response errorResp;
-                            errorResp.status = "error";
-                            errorResp.message = "Invalid JSON request";
-                            string errorJson = errorResp.toJson();
-                            send(clientSocket, errorJson.c_str(), errorJson.length(), 0);
-                            continue;
+                        framer.feed(buffer, bytesRead);
+                        JsonFrame frame;
+                        while ((frame = framer.next(requestStr)) != JsonFrame::NEED_MORE) {
+                            if (frame == JsonFrame::INVALID) {
+                                cerr << "[SERVER][ERROR] Invalid JSON request from client " << clientSocket << endl;
+                                Response errorResp;
+                                errorResp.status = "error";
+                                errorResp.message = "Invalid JSON request";
+                                string errorJson = errorResp.toJson();
+                                send(clientSocket, errorJson.c_str(), errorJson.length(), 0);
+                                break;
+                            }
+                            {//обработка запроса в рабочем поткое
+                                lock_guard<mutex> lock(queueMutex);
+                                requestQueue.push({clientSocket, requestStr});
+                            }
+                            queueCV.notify_one();
                         }
-                        
-                        {//обработка запроса в рабочем поткое
-                            lock_guard<mutex> lock(queueMutex);
-                            requestQueue.push({clientSocket, string(buffer)});
+                        if (frame == JsonFrame::INVALID) {
+                            break;//где начинается следующий запрос, неизвестно - закрываем соединение
                         }
-                        queueCV.notify_one();
                         
                     } else if (bytesRead == 0) {
                         cout << "[SERVER] Client " << clientSocket << " disconnected" << endl;
@@ -158,6 +162,7 @@ bool ConnectionManager::start(int port, int numWorkers) {
                         }
                     }
                 }
+                changeStreams.unsubscribe(clientSocket);
                 close(clientSocket);
                 
             }).detach();
@@ -167,45 +172,6 @@ bool ConnectionManager::start(int port, int numWorkers) {
     return true;
 }
 
-bool ConnectionManager::isValidJsonRequest(const string& jsonStr) {
-    int braceCount = 0;
-    int bracketCount = 0;
-    bool inString = false;
-    bool escaped = false;
-    
-    for (size_t i = 0; i < jsonStr.length(); i++) {
-        char c = jsonStr[i];
-        
-        if (escaped) {
-            escaped = false;
-            continue;
-        }
-        
-        if (c == '\\') {
-            escaped = true;
-            continue;
-        }
-        
-        if (c == '"' && !escaped) {
-            inString = !inString;
-            continue;
-        }
-        
-        if (!inString) {
-            if (c == '{') braceCount++;
-            else if (c == '}') braceCount--;
-            else if (c == '[') bracketCount++;
-            else if (c == ']') bracketCount--;
-        }
-        
-        if (braceCount < 0 || bracketCount < 0) {
-            return false;
-        }
-    }
-    
-    return (braceCount == 0 && bracketCount == 0 && !inString);
-}
-
 void ConnectionManager::stop() {    
     if (!running) return;
     running = false;
@@ -226,6 +192,7 @@ void ConnectionManager::stop() {
 }
 
 void ConnectionManager::workerThread() {    
+    Arena requestArena;//у каждого рабочего потока своя, очищается после каждого запроса
     while (running) {
         pair<int, string> request;       
         {
@@ -245,6 +212,7 @@ void ConnectionManager::workerThread() {
                 continue;
             }
         }
+        ArenaScope scope(&requestArena);
         processRequest(request.first, request.second);
     }
 }
@@ -252,23 +220,41 @@ void ConnectionManager::workerThread() {
 void ConnectionManager::processRequest(int clientSocket, const string& requestData) {
     try {
         Request req = Request::fromJson(requestData);
-        Response resp;
+        string responseJson;//find и execute отдают готовую строку, часто из кэша
+        ArenaString builtJson;//остальные ответы собираются в арене запроса
         
-        if (req.operation == "insert") {
-            resp = insertDocument(req);
+        if (req.operation == "subscribe") {
+            subscribe(clientSocket, req);
+            return;
         } else if (req.operation == "find") {
-            resp = findDocuments(req);
-        } else if (req.operation == "delete") {
-            resp = deleteDocuments(req);
+            responseJson = findDocuments(req);//уже сериализован, может прийти из кэша
+        } else if (req.operation == "execute") {
+            responseJson = executePrepared(req);
         } else {
-            cerr << "[SERVER][ERROR] Unknown operation: " << req.operation << endl;
-            resp.status = "error";
-            resp.message = "Unknown operation: " + req.operation;
+            Response resp;
+            if (req.operation == "insert") {
+                resp = insertDocument(req);
+            } else if (req.operation == "delete") {
+                resp = deleteDocuments(req);
+            } else if (req.operation == "update") {
+                resp = updateDocuments(req);
+            } else if (req.operation == "prepare") {
+                resp = prepareQuery(req);
+            } else if (req.operation == "distinctCount") {
+                resp = distinctCount(req);
+            } else if (req.operation == "histogram") {
+                resp = histogram(req);
+            } else {
+                cerr << "[SERVER][ERROR] Unknown operation: " << req.operation << endl;
+                resp.status = "error";
+                resp.message = "Unknown operation: " + req.operation;
+            }
+            resp.writeJson(builtJson);
         }
         
-        string responseJson = resp.toJson();
-        
-        int bytesSent = send(clientSocket, responseJson.c_str(), responseJson.length(), 0);
+        const char* payload = builtJson.empty() ? responseJson.c_str() : builtJson.c_str();
+        size_t payloadLength = builtJson.empty() ? responseJson.length() : builtJson.length();
+        int bytesSent = send(clientSocket, payload, payloadLength, 0);
         if (bytesSent < 0) {
             cerr << "[SERVER][ERROR] Failed to send response to client " << clientSocket 
                  << ", errno: " << errno << endl;
@@ -296,24 +282,8 @@ void ConnectionManager::processRequest(int clientSocket, const string& requestDa
 
 Response ConnectionManager::insertDocument(const Request& req) {    
     Response resp;
-    Database* dbValue = nullptr;
-    bool found = databases.get(req.database, dbValue);
-    mutex* mutexPtr = nullptr;
-    bool mutexFound = dbMutexes.get(req.database, mutexPtr);
-    
-    if (!mutexFound) {
-        lock_guard<mutex> lock(mapMutex);
-        mutex* newMutex = new mutex();
-        dbMutexes.put(req.database, newMutex);
-        mutexFound = dbMutexes.get(req.database, mutexPtr);
-    }
-    
-    if (!mutexPtr) {
-        resp.status = "error";
-        resp.message = "Failed to get database mutex";
-        resp.count = 0;
-        return resp;
-    }
+    CatalogEntry* entry = catalog.getOrCreate(req.database);
+    mutex* mutexPtr = &entry->lock;
     
     bool lockAcquired = false;//захват мютекса с таймаутом
     auto startTime = chrono::steady_clock::now();
@@ -327,31 +297,31 @@ Response ConnectionManager::insertDocument(const Request& req) {
     }
     
     if (lockAcquired) {
-        Database* db = nullptr;
-        if (!found) {
-            db = new Database(req.database);
-            databases.put(req.database, db);
-        } else {
-            db = dbValue;
-        }
+        Database* db = entry->database;
         Collection& coll = db->getCollection(req.collection);
+        bool watched = changeStreams.isWatched(req.database, req.collection);
 
         int insertedCount = 0;
         Vector<string> insertedIds;
         
+        JsonDocument parsed;//документ разбирается один раз, коллекция строит его прямо из дерева
         for (size_t i = 0; i < req.data.size(); i++) {
-            JsonParser parser;
             try {
-                HashMap<string, string> docData = parser.parse(req.data[i]);
-                if (docData.size() == 0 && req.data[i] != "{}") {
+                parsed.parse(req.data[i]);
+                JsonValue docData = parsed.root();
+                if (!docData.isObject() || (docData.size() == 0 && req.data[i] != "{}")) {
                     cerr << "[SERVER][WARN] Invalid JSON document: " << req.data[i] << endl;
                     continue;
                 }
                 
-                string result = coll.insert(req.data[i]);
+                DocumentRef inserted;
+                string result = coll.insert(docData, watched ? &inserted : nullptr);
                 
                 if (result.find("successfully") != string::npos) {
                     insertedCount++;
+                    if (watched) {
+                        changeStreams.publish(req.database, req.collection, inserted);
+                    }
                     size_t pos = result.find("doc_");
                     if (pos != string::npos) {
                         size_t end = result.find(" ", pos);
@@ -371,7 +341,7 @@ Response ConnectionManager::insertDocument(const Request& req) {
         resp.message = "Inserted " + to_string(insertedCount) + " document(s)";
         resp.count = insertedCount;
         for (size_t i = 0; i < insertedIds.size(); i++) {
-            resp.data.push_back("{\"id\":\"" + insertedIds[i] + "\"}");
+            resp.addRaw("{\"id\":\"" + insertedIds[i] + "\"}");
         }
         mutexPtr->unlock();
         
@@ -384,60 +354,165 @@ Response ConnectionManager::insertDocument(const Request& req) {
     return resp;
 }
 
-Response ConnectionManager::findDocuments(const Request& req) {    
-    Response resp;
-    Database* dbValue = nullptr;
-    bool dbFound = databases.get(req.database, dbValue);
-    
-    if (!dbFound) {
-        cerr << "[SERVER][ERROR] Database not found: " << req.database << endl;
+string ConnectionManager::findDocuments(const Request& req) {    
+    ConditionParser parser;
+    QueryCondition condition = parser.parse(req.query);
+    if (!parser.getError().empty()) {
+        Response resp;
         resp.status = "error";
-        resp.message = "Database not found: " + req.database;
+        resp.message = parser.getError();
         resp.count = 0;
-        return resp;
+        return resp.toJson();
     }
-    mutex* mutexPtr = nullptr;
-    bool mutexFound = dbMutexes.get(req.database, mutexPtr);
+    return runFind(req.database, req.collection, condition, Projection::parse(req.projection));
+}
+
+string ConnectionManager::runFind(const string& database, const string& collection,
+                                  const QueryCondition& condition, const Projection& projection) {
+    Response resp;
+    CatalogEntry* entry = catalog.find(database);
     
-    if (!mutexFound || !mutexPtr) {
-        cerr << "[SERVER][ERROR] Database mutex not found: " << req.database << endl;
+    if (!entry) {
+        cerr << "[SERVER][ERROR] Database not found: " << database << endl;
         resp.status = "error";
-        resp.message = "Database not initialized: " + req.database;
+        resp.message = "Database not found: " + database;
         resp.count = 0;
-        return resp;
+        return resp.toJson();
     }
-    lock_guard<mutex> lock(*mutexPtr);//ссфлка мьютекс для чтения
+    lock_guard<mutex> lock(entry->lock);//ссфлка мьютекс для чтения
     
-    Database* db = dbValue;
-    Collection& coll = db->getCollection(req.collection);
+    Database* db = entry->database;
+    Collection& coll = db->getCollection(collection);
 
-    ConditionParser parser;
-    QueryCondition condition = parser.parse(req.query);
+    //версия читается под мьютексом бд, поэтому не может устареть до put
+    string cacheKey = QueryCache::makeKey(database, collection, condition, projection);
+    string cached;
+    if (queryCache.get(cacheKey, coll.getVersion(), cached)) {
+        return cached;
+    }
 
-    Vector<Document> results = coll.find(condition);
+    Vector<DocumentRef> results = coll.find(condition);
     resp.status = "success";
     resp.message = "Found " + to_string(results.size()) + " document(s)";
     resp.count = results.size();
     
+    resp.data.reserve(results.size());
+    resp.rawData.reserve(results.size());
     for (size_t i = 0; i < results.size(); i++) {
-        resp.data.push_back(results[i].to_json());
+        resp.addRaw(results[i]->to_json(projection));//контейнеры проверены строго при вставке и загрузке
+    }
+    
+    string responseJson = resp.toJson();
+    queryCache.put(cacheKey, coll.getVersion(), responseJson);
+    return responseJson;
+}
+
+Response ConnectionManager::prepareQuery(const Request& req) {
+    Response resp;
+    resp.count = 0;
+    if (req.database.empty() || req.collection.empty()) {
+        resp.status = "error";
+        resp.message = "Prepare requires database and collection";
+        return resp;
+    }
+    
+    ConditionParser parser;
+    QueryCondition condition = parser.parse(req.query);
+    if (!parser.getError().empty()) {
+        resp.status = "error";
+        resp.message = parser.getError();
+        return resp;
     }
+    Projection projection = Projection::parse(req.projection);
+    //одинаковый запрос получает тот же handle, повторные prepare не плодят записи
+    string key = QueryCache::makeKey(req.database, req.collection, condition, projection);
     
+    string handle;
+    {
+        lock_guard<mutex> lock(preparedMutex);
+        if (!preparedHandles.get(key, handle)) {
+            if (preparedQueries.size() >= MAX_PREPARED_QUERIES) {
+                resp.status = "error";
+                resp.message = "Too many prepared queries";
+                return resp;
+            }
+            handle = "q" + to_string(nextPreparedId++);
+            PreparedQuery* prepared = new PreparedQuery();
+            prepared->database = req.database;
+            prepared->collection = req.collection;
+            prepared->condition = std::move(condition);
+            prepared->projection = projection;
+            preparedQueries.put(handle, prepared);
+            preparedHandles.put(key, handle);
+        }
+    }
+    
+    resp.status = "success";
+    resp.message = "Prepared query " + handle;
+    resp.count = 1;
+    resp.addRaw("{\"handle\":\"" + handle + "\"}");
     return resp;
 }
 
+string ConnectionManager::executePrepared(const Request& req) {
+    Response resp;
+    resp.count = 0;
+    
+    QueryCondition condition;
+    Projection projection;
+    string database;
+    string collection;
+    {
+        lock_guard<mutex> lock(preparedMutex);
+        PreparedQuery* prepared = nullptr;
+        if (!preparedQueries.get(req.handle, prepared)) {
+            resp.status = "error";
+            resp.message = "Unknown prepared query: " + req.handle;
+            return resp.toJson();
+        }
+        condition = prepared->condition;
+        projection = prepared->projection;
+        database = prepared->database;
+        collection = prepared->collection;
+    }
+    
+    if (condition.hasParameters()) {
+        HashMap<string, string> params;
+        if (!req.data.empty()) {
+            JsonParser parser;
+            params = parser.parse(req.data[0]);
+        }
+        string error;
+        if (!condition.bindParameters(params, error)) {
+            resp.status = "error";
+            resp.message = error;
+            return resp.toJson();
+        }
+    }
+    
+    return runFind(database, collection, condition, projection);
+}
+
 Response ConnectionManager::deleteDocuments(const Request& req) {    
     Response resp;
-    mutex* mutexPtr = nullptr;
-    bool mutexFound = dbMutexes.get(req.database, mutexPtr);
+    ConditionParser parser;
+    QueryCondition condition = parser.parse(req.query);
+    if (!parser.getError().empty()) {
+        resp.status = "error";
+        resp.message = parser.getError();
+        resp.count = 0;
+        return resp;
+    }
+    CatalogEntry* entry = catalog.find(req.database);
     
-    if (!mutexFound || !mutexPtr) {
+    if (!entry) {
         cerr << "[SERVER][ERROR] Database not found: " << req.database << endl;
         resp.status = "error";
         resp.message = "Database not found: " + req.database;
         resp.count = 0;
         return resp;
     }
+    mutex* mutexPtr = &entry->lock;
     
     bool lockAcquired = false;
     auto startTime = chrono::steady_clock::now();
@@ -451,23 +526,9 @@ Response ConnectionManager::deleteDocuments(const Request& req) {
     }
     
     if (lockAcquired) {
-        Database* dbValue = nullptr;
-        bool dbFound = databases.get(req.database, dbValue);
-        
-        if (!dbFound) {
-            resp.status = "error";
-            resp.message = "Database not found: " + req.database;
-            resp.count = 0;
-            mutexPtr->unlock();
-            return resp;
-        }
-        
-        Database* db = dbValue;
+        Database* db = entry->database;
         Collection& coll = db->getCollection(req.collection);
 
-        ConditionParser parser;
-        QueryCondition condition = parser.parse(req.query);
-
         string result = coll.remove(condition);
 
         if (result.find("successfully") != string::npos) {
@@ -510,4 +571,257 @@ Response ConnectionManager::deleteDocuments(const Request& req) {
         resp.count = 0;
     }
     return resp;
-}
\ No newline at end of file
+}
+
+//data[0]: {"field":"user","precision":14}, точность необязательна
+Response ConnectionManager::distinctCount(const Request& req) {
+    Response resp;
+    resp.count = 0;
+    
+    string field;
+    int precision = HyperLogLog::DEFAULT_PRECISION;
+    if (!req.data.empty()) {
+        JsonParser parser;
+        HashMap<string, string> spec = parser.parse(req.data[0]);
+        spec.get("field", field);
+        string precisionStr;
+        if (spec.get("precision", precisionStr)) {
+            try {
+                precision = stoi(precisionStr);
+            } catch (...) {
+                precision = -1;
+            }
+        }
+    }
+    if (field.empty()) {
+        resp.status = "error";
+        resp.message = "distinctCount requires a field";
+        return resp;
+    }
+    if (precision < HyperLogLog::MIN_PRECISION || precision > HyperLogLog::MAX_PRECISION) {
+        resp.status = "error";
+        resp.message = "Precision must be between " + to_string(HyperLogLog::MIN_PRECISION) +
+                       " and " + to_string(HyperLogLog::MAX_PRECISION);
+        return resp;
+    }
+    
+    CatalogEntry* entry = catalog.find(req.database);
+    if (!entry) {
+        cerr << "[SERVER][ERROR] Database not found: " << req.database << endl;
+        resp.status = "error";
+        resp.message = "Database not found: " + req.database;
+        return resp;
+    }
+    
+    ConditionParser parser;
+    QueryCondition condition = parser.parse(req.query);
+    if (!parser.getError().empty()) {
+        resp.status = "error";
+        resp.message = parser.getError();
+        return resp;
+    }
+    size_t matched = 0;
+    HyperLogLog sketch;
+    {
+        lock_guard<mutex> lock(entry->lock);
+        Collection& coll = entry->database->getCollection(req.collection);
+        sketch = coll.distinctCount(condition, field, precision, matched);
+    }
+    
+    uint64_t distinct = sketch.estimate();
+    resp.status = "success";
+    resp.message = "Approximately " + to_string(distinct) + " distinct value(s) of " + field;
+    resp.count = 1;
+    string row = "{\"field\":";
+    JsonWriter::appendQuoted(row, field);
+    row += ",\"distinct\":";
+    JsonWriter::appendInteger(row, distinct);
+    row += ",\"matched\":";
+    JsonWriter::appendInteger(row, matched);
+    row += ",\"precision\":";
+    JsonWriter::appendInteger(row, precision);
+    row += ",\"standardError\":";
+    JsonWriter::appendFixed(row, sketch.standardError(), 4);
+    row += "}";
+    resp.addRaw(row);
+    return resp;
+}
+
+//data[0]: {"resumeToken":"..."} - продолжить с места обрыва соединения
+void ConnectionManager::subscribe(int clientSocket, const Request& req) {
+    Response resp;
+    resp.count = 0;
+    
+    string resumeToken;
+    if (!req.data.empty()) {
+        JsonParser parser;
+        HashMap<string, string> spec = parser.parse(req.data[0]);
+        spec.get("resumeToken", resumeToken);
+    }
+    
+    CatalogEntry* entry = catalog.getOrCreate(req.database);//подписка может прийти раньше первой вставки
+    
+    ConditionParser parser;
+    QueryCondition condition = parser.parse(req.query);
+    string error = parser.getError();
+    bool subscribed = false;
+    if (error.empty()) {
+        //под мьютексом базы вставки не идут, поэтому ответ уйдет раньше первого события
+        lock_guard<mutex> lock(entry->lock);
+        entry->database->getCollection(req.collection);
+        subscribed = changeStreams.subscribe(clientSocket, req.database, req.collection, condition,
+                                             Projection::parse(req.projection), resumeToken, error);
+    }
+    
+    if (subscribed) {
+        cout << "[SERVER] Client " << clientSocket << " subscribed to " 
+             << req.database << "." << req.collection << endl;
+        return;
+    }
+    cerr << "[SERVER][ERROR] Subscribe failed for client " << clientSocket << ": " << error << endl;
+    resp.status = "error";
+    resp.message = error;
+    string responseJson = resp.toJson();
+    send(clientSocket, responseJson.c_str(), responseJson.length(), MSG_NOSIGNAL);
+}
+
+//data[0]: {"field":"timestamp","interval":"1m","splitBy":"severity"}
+Response ConnectionManager::histogram(const Request& req) {
+    Response resp;
+    resp.count = 0;
+    
+    string field = "timestamp";
+    string intervalStr = "1m";
+    string splitField;
+    if (!req.data.empty()) {
+        JsonParser parser;
+        HashMap<string, string> spec = parser.parse(req.data[0]);
+        spec.get("field", field);
+        spec.get("interval", intervalStr);
+        spec.get("splitBy", splitField);
+    }
+    int64_t interval = 0;
+    if (!TimeHistogram::parseInterval(intervalStr, interval)) {
+        resp.status = "error";
+        resp.message = "Interval must be between 1s and 1d, e.g. 30s, 5m, 1h";
+        return resp;
+    }
+    
+    CatalogEntry* entry = catalog.find(req.database);
+    if (!entry) {
+        cerr << "[SERVER][ERROR] Database not found: " << req.database << endl;
+        resp.status = "error";
+        resp.message = "Database not found: " + req.database;
+        return resp;
+    }
+    
+    ConditionParser parser;
+    QueryCondition condition = parser.parse(req.query);
+    if (!parser.getError().empty()) {
+        resp.status = "error";
+        resp.message = parser.getError();
+        return resp;
+    }
+    TimeHistogram result(interval);
+    size_t matched = 0;
+    {
+        lock_guard<mutex> lock(entry->lock);
+        Collection& coll = entry->database->getCollection(req.collection);
+        matched = coll.histogram(condition, field, splitField, result);
+    }
+    
+    if (result.isOverflowed()) {
+        resp.status = "error";
+        resp.message = "More than " + to_string(TimeHistogram::MAX_BUCKETS) + " buckets, use a larger interval";
+        return resp;
+    }
+    
+    resp.status = "success";
+    resp.message = to_string(result.bucketCount()) + " bucket(s) for " + to_string(matched) + " document(s)";
+    if (result.skippedCount() > 0) {
+        resp.message += ", " + to_string(result.skippedCount()) + " with unparsable " + field;
+    }
+    Vector<string> rows = result.toJsonRows();
+    for (size_t i = 0; i < rows.size(); i++) {
+        resp.addRaw(move(rows[i]));
+    }
+    resp.count = resp.data.size();
+    return resp;
+}
+
+Response ConnectionManager::updateDocuments(const Request& req) {
+    Response resp;
+    resp.count = 0;
+    
+    UpdateSpec spec;
+    string specError;
+    if (req.data.empty()) {
+        resp.status = "error";
+        resp.message = "Update requires modifiers in data";
+        return resp;
+    }
+    if (!UpdateSpec::parse(req.data[0], spec, specError)) {
+        resp.status = "error";
+        resp.message = specError;
+        return resp;
+    }
+    ConditionParser parser;
+    QueryCondition condition = parser.parse(req.query);
+    if (!parser.getError().empty()) {
+        resp.status = "error";
+        resp.message = parser.getError();
+        return resp;
+    }
+    
+    CatalogEntry* entry = catalog.find(req.database);
+    
+    if (!entry) {
+        cerr << "[SERVER][ERROR] Database not found: " << req.database << endl;
+        resp.status = "error";
+        resp.message = "Database not found: " + req.database;
+        return resp;
+    }
+    mutex* mutexPtr = &entry->lock;
+    
+    bool lockAcquired = false;
+    auto startTime = chrono::steady_clock::now();
+    
+    while (chrono::steady_clock::now() - startTime < chrono::seconds(10)) {
+        if (mutexPtr->try_lock()) {
+            lockAcquired = true;
+            break;
+        }
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+    
+    if (!lockAcquired) {
+        cerr << "[SERVER][ERROR] Database lock timeout for update: " << req.database << endl;
+        resp.status = "error";
+        resp.message = "Database lock timeout for: " + req.database;
+        return resp;
+    }
+    
+    Collection& coll = entry->database->getCollection(req.collection);
+    
+    string result = coll.update(condition, spec);
+    
+    if (result.find("successfully") != string::npos) {
+        resp.status = "success";
+        resp.message = result;
+        size_t spacePos = result.find(' ');
+        try {
+            resp.count = stoi(result.substr(0, spacePos));
+        } catch (const exception& e) {
+            cerr << "[SERVER][ERROR] Failed to parse update count: " << e.what() << endl;
+        }
+    } else if (result.find("No documents found") != string::npos) {
+        resp.status = "success";
+        resp.message = result;
+    } else {
+        resp.status = "error";
+        resp.message = result;
+    }
+    
+    mutexPtr->unlock();
+    return resp;
+}
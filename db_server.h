@@ -2,7 +2,12 @@
 #define DB_SERVER_H
 
 #include "database.h"
+#include "database_catalog.h"
 #include "network_protocol.h"
+#include "query_cache.h"
+#include "change_stream.h"
+#include "QueryCondition.h"
+#include "projection.h"
 #include "HashMap.h"
 #include "vector.h"
 #include <mutex>
@@ -11,14 +16,22 @@
 #include <thread>
 #include <memory>
 
+//разобранное один раз условие, выполняется по handle
+struct PreparedQuery {
+    string database;
+    string collection;
+    QueryCondition condition;
+    Projection projection;
+};
+
 class ConnectionManager {
 private:
+    static const size_t MAX_PREPARED_QUERIES = 4096;
+    
     bool running;
     int serverSocket;
     
-    HashMap<string, Database*> databases;
-    HashMap<string, mutex*> dbMutexes; 
-    mutex mapMutex;
+    DatabaseCatalog catalog;
     
     queue<pair<int, string>> requestQueue;
     mutex queueMutex;
@@ -26,14 +39,28 @@ private:
     
     Vector<thread> workerThreads; 
     
-    bool isValidJsonRequest(const string& jsonStr);
+    QueryCache queryCache;
+    ChangeStreams changeStreams;
+    
+    HashMap<string, PreparedQuery*> preparedQueries;//handle -> запрос
+    HashMap<string, string> preparedHandles;//нормализованный запрос -> handle
+    mutex preparedMutex;
+    size_t nextPreparedId;
     
     void workerThread();
     void processRequest(int clientSocket, const string& requestData);
     
     Response insertDocument(const Request& req);
-    Response findDocuments(const Request& req);
+    string findDocuments(const Request& req);
+    string runFind(const string& database, const string& collection,
+                   const QueryCondition& condition, const Projection& projection);
+    Response prepareQuery(const Request& req);
+    string executePrepared(const Request& req);
     Response deleteDocuments(const Request& req);
+    Response updateDocuments(const Request& req);
+    Response distinctCount(const Request& req);
+    Response histogram(const Request& req);
+    void subscribe(int clientSocket, const Request& req);//ответ и события отправляет сам
     
 public:
     ConnectionManager();
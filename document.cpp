@@ -1,26 +1,211 @@
 #include "document.h"
-#include "JsonParser.h"
+#include "json_path.h"
+#include "json_writer.h"
+#include <vector>
+#include <cstdio>
+#include <cmath>
+#include <new>
+#include <utility>
+#include <atomic>
 
-Document::Document() {
-    static int counter = 0;
+Document::Document() : fields(nullptr), fieldCount(0), fieldCapacity(0), dense(false) {
+    static atomic<int> counter(0);
     id = "doc_" + to_string(counter++);
 }
 
-Document::Document(const string& jsonStr) {
-    static int counter = 0;
+Document::Document(const string& jsonStr) : fields(nullptr), fieldCount(0), fieldCapacity(0), dense(false) {
+    static atomic<int> counter(0);
     id = "doc_" + to_string(counter++);
-    JsonParser parser;
-    data = parser.parse(jsonStr);
+    JsonDocument parsed;
+    if (parsed.parse(jsonStr)) {
+        assign(parsed.root());
+    }
 }
 
-Document::Document(const HashMap<string, string>& dataMap, const string& docId) {
+Document::Document(const HashMap<string, string>& dataMap, const string& docId,
+                   const shared_ptr<FieldTable>& table)
+    : fields(nullptr), fieldCount(0), fieldCapacity(0), dense(false), schema(table) {
     if (docId.empty()) {
-        static int counter = 0;
+        static atomic<int> counter(0);
         id = "doc_" + to_string(counter++);
     } else {
         id = docId;
     }
-    data = dataMap;
+    assign(dataMap);
+}
+
+Document::Document(const JsonValue& object, const string& docId, const shared_ptr<FieldTable>& table)
+    : fields(nullptr), fieldCount(0), fieldCapacity(0), dense(false), schema(table), id(docId) {
+    assign(object);
+    setField("_id", id);
+}
+
+Document::Document(const Document& other)
+    : fields(nullptr), fieldCount(0), fieldCapacity(0), dense(false), schema(other.schema), id(other.id) {
+    copyFields(other);
+}
+
+Document& Document::operator=(const Document& other) {
+    if (this != &other) {
+        releaseFields();
+        schema = other.schema;
+        id = other.id;
+        copyFields(other);
+    }
+    return *this;
+}
+
+//массив уходит вместе с таблицей, из пула которой он выделен
+Document::Document(Document&& other) noexcept
+    : fields(other.fields), fieldCount(other.fieldCount), fieldCapacity(other.fieldCapacity),
+      dense(other.dense), schema(std::move(other.schema)), id(std::move(other.id)) {
+    other.fields = nullptr;
+    other.fieldCount = 0;
+    other.fieldCapacity = 0;
+}
+
+Document& Document::operator=(Document&& other) noexcept {
+    if (this != &other) {
+        releaseFields();
+        fields = other.fields;
+        fieldCount = other.fieldCount;
+        fieldCapacity = other.fieldCapacity;
+        dense = other.dense;
+        schema = std::move(other.schema);
+        id = std::move(other.id);
+        other.fields = nullptr;
+        other.fieldCount = 0;
+        other.fieldCapacity = 0;
+    }
+    return *this;
+}
+
+Document::~Document() {
+    releaseFields();
+}
+
+void Document::reserveFields(size_t count) {
+    if (count <= fieldCapacity) {
+        return;
+    }
+    size_t newCapacity = fieldCapacity == 0 ? 4 : fieldCapacity * 2;
+    if (newCapacity < count) {
+        newCapacity = count;
+    }
+    FieldValue* newFields = schema->pool().allocateArray<FieldValue>(newCapacity);
+    for (size_t i = 0; i < fieldCount; i++) {
+        new (&newFields[i]) FieldValue(std::move(fields[i]));
+        fields[i].~FieldValue();
+    }
+    if (fields) {
+        schema->pool().deallocateArray(fields, fieldCapacity);
+    }
+    fields = newFields;
+    fieldCapacity = static_cast<uint32_t>(newCapacity);
+}
+
+void Document::clearFields() {
+    for (size_t i = 0; i < fieldCount; i++) {
+        fields[i].~FieldValue();
+    }
+    fieldCount = 0;
+    dense = false;
+}
+
+void Document::releaseFields() {
+    clearFields();
+    if (fields) {
+        schema->pool().deallocateArray(fields, fieldCapacity);
+    }
+    fields = nullptr;
+    fieldCapacity = 0;
+}
+
+//копия берет массив из пула той же таблицы, лишнюю емкость не переносит
+void Document::copyFields(const Document& other) {
+    if (other.fieldCount == 0) {
+        return;
+    }
+    reserveFields(other.fieldCount);
+    dense = other.dense;
+    for (; fieldCount < other.fieldCount; fieldCount++) {
+        new (&fields[fieldCount]) FieldValue(other.fields[fieldCount]);
+    }
+}
+
+//переход на индексацию номером поля: массив длиной не меньше minCount, пустые ячейки с NO_FIELD
+void Document::makeDense(size_t minCount) {
+    size_t count = fieldCount > 0 ? fields[fieldCount - 1].fieldId + 1 : 0;
+    if (count < minCount) {
+        count = minCount;
+    }
+    FieldValue* denseFields = schema->pool().allocateArray<FieldValue>(count);
+    for (size_t i = 0; i < count; i++) {
+        new (&denseFields[i]) FieldValue();
+    }
+    for (size_t i = 0; i < fieldCount; i++) {
+        denseFields[fields[i].fieldId] = std::move(fields[i]);
+    }
+    releaseFields();
+    fields = denseFields;
+    fieldCount = static_cast<uint32_t>(count);
+    fieldCapacity = static_cast<uint32_t>(count);
+    dense = true;
+}
+
+Document::FieldValue* Document::findField(int fieldId) {
+    return const_cast<FieldValue*>(fieldAt(fieldId));
+}
+
+//в HashMap вид значения потерян, все поля считаются строками
+void Document::assign(const HashMap<string, string>& dataMap) {
+    clearFields();
+    for (const auto& entry : dataMap) {
+        setField(entry.key, entry.value);
+    }
+}
+
+//значения те же, что дал бы JsonParser: вложенные объекты и массивы исходным текстом,
+//вид запоминается здесь, пока он известен из разбора. контейнер, не прошедший строгую
+//проверку, хранится строкой - так to_json можно отдавать в ответ без повторного разбора
+void Document::assign(const JsonValue& object) {
+    clearFields();
+    if (!object.isObject()) {
+        return;
+    }
+    for (size_t i = 0; i < object.size(); i++) {
+        JsonValue member = object[i];
+        JsonSpan text = member.text();
+        bool container = (member.isObject() || member.isArray()) && JsonTokenizer::isValid(text.data, text.length);
+        setField(member.name().str(), text.str(), container);
+    }
+}
+
+const Document::FieldValue* Document::fieldAt(int fieldId) const {
+    if (fieldId < 0) {
+        return nullptr;
+    }
+    uint32_t id = static_cast<uint32_t>(fieldId);
+    if (dense) {
+        return id < fieldCount && fields[id].fieldId == id ? &fields[id] : nullptr;
+    }
+    size_t low = 0, high = fieldCount;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (fields[middle].fieldId < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < fieldCount && fields[low].fieldId == id ? &fields[low] : nullptr;
+}
+
+const string& Document::valueOf(size_t fieldId, const FieldValue& field) const {
+    if (field.code != StringDictionary::NO_CODE) {
+        return schema->dictionaries().dictionary(schema->dictSlot(fieldId)).decode(field.code);
+    }
+    return field.value;
 }
 
 string Document::getId() const {
@@ -28,35 +213,253 @@ string Document::getId() const {
 }
 
 void Document::setData(const HashMap<string, string>& newData) {
-    data = newData;
+    assign(newData);
 }
 
 HashMap<string, string> Document::getData() const {
-    return data;
+    HashMap<string, string> result;
+    for (size_t i = 0; i < fieldCount; i++) {
+        if (fields[i].fieldId != NO_FIELD) {
+            result.put(schema->name(fields[i].fieldId), valueOf(fields[i].fieldId, fields[i]));
+        }
+    }
+    return result;
+}
+
+bool Document::getField(const string& field, string& value) const {
+    if (!schema) {
+        return false;
+    }
+    int fieldId = schema->idOf(field);
+    const FieldValue* stored = fieldAt(fieldId);
+    if (!stored) {
+        return false;
+    }
+    value = valueOf(fieldId, *stored);
+    return true;
+}
+
+void Document::setField(const string& field, const string& value, bool container) {
+    if (!schema) {
+        schema = make_shared<FieldTable>();//документ вне коллекции
+    }
+    size_t fieldId = schema->intern(field);
+    FieldValue* found = findField(static_cast<int>(fieldId));
+    if (!found && !dense && fieldCount >= SMALL_FIELDS) {
+        makeDense(fieldId + 1);
+    }
+    if (!found && dense) {
+        reserveFields(fieldId + 1);
+        while (fieldCount <= fieldId) {
+            new (&fields[fieldCount++]) FieldValue();
+        }
+        found = &fields[fieldId];
+    } else if (!found) {
+        size_t position = fieldCount;
+        while (position > 0 && fields[position - 1].fieldId > fieldId) {
+            position--;
+        }
+        reserveFields(fieldCount + 1);
+        new (&fields[fieldCount]) FieldValue();
+        for (size_t i = fieldCount; i > position; i--) {
+            fields[i] = std::move(fields[i - 1]);
+        }
+        fieldCount++;
+        fields[position] = FieldValue();
+        found = &fields[position];
+    }
+
+    FieldValue& stored = *found;
+    stored.fieldId = static_cast<uint32_t>(fieldId);
+    stored.code = StringDictionary::NO_CODE;
+    stored.container = container;
+    int slot = schema->dictSlot(fieldId);
+    if (slot >= 0) {
+        stored.code = schema->dictionaries().dictionary(slot).encode(value);
+    }
+    if (stored.code != StringDictionary::NO_CODE) {
+        stored.value.clear();
+    } else {
+        stored.value = value;//словаря нет или он заполнен
+    }
+}
+
+bool Document::removeField(const string& field) {
+    if (!schema) {
+        return false;
+    }
+    FieldValue* stored = findField(schema->idOf(field));
+    if (!stored) {
+        return false;
+    }
+    if (dense) {
+        *stored = FieldValue();
+        return true;
+    }
+    for (FieldValue* next = stored + 1; next < fields + fieldCount; stored++, next++) {
+        *stored = std::move(*next);
+    }
+    fields[--fieldCount].~FieldValue();
+    return true;
+}
+
+//целые остаются целыми, иначе без хвостовых нулей to_string
+static string formatNumber(double number) {
+    char buffer[64];
+    if (std::fabs(number) < 1e15 && number == std::floor(number)) {
+        snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(number));
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.15g", number);
+    }
+    return string(buffer);
+}
+
+bool Document::applyUpdate(const UpdateSpec& spec) {
+    bool changed = false;
+
+    for (const auto& entry : spec.setFields) {
+        bool container = false;
+        spec.setContainers.get(entry.key, container);
+        const FieldValue* stored = schema ? fieldAt(schema->idOf(entry.key)) : nullptr;
+        if (!stored || stored->container != container || valueOf(stored->fieldId, *stored) != entry.value) {
+            setField(entry.key, entry.value, container);
+            changed = true;
+        }
+    }
+
+    for (const auto& entry : spec.incFields) {
+        string current;
+        double base = 0;
+        if (getField(entry.key, current)) {
+            try {
+                base = stod(current);
+            } catch (...) {
+                continue;//не число, поле не трогаем
+            }
+        }
+        double delta = stod(entry.value);
+        setField(entry.key, formatNumber(base + delta));
+        changed = changed || delta != 0 || current.empty();
+    }
+
+    for (size_t i = 0; i < spec.unsetFields.size(); i++) {
+        if (removeField(spec.unsetFields[i])) {
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+//объекты и массивы хранятся исходным текстом и пишутся без кавычек, все прочее - строкой
+static void appendJsonValue(string& json, const string& value, bool container) {
+    if (container) {
+        json += value;
+    } else {
+        JsonWriter::appendQuoted(json, value);
+    }
 }
 
 string Document::to_json() const {
-    string json = "{";
-    auto items = data.items();
-    bool first = true;
-    
-    if (!first) json += ",";//1-id
-    json += "\"_id\":\"" + id + "\"";
-    first = false;
+    string json = "{\"_id\":";
+    JsonWriter::appendQuoted(json, id);
     
-    for (size_t i = 0; i < items.size(); i++) {//остальные поля
-        if (items[i].first != "_id") {
-            if (!first) {
-                json += ",";
-            }
-            json += "\"" + items[i].first + "\":\"" + items[i].second + "\"";
-            first = false;
+    for (size_t i = 0; i < fieldCount; i++) {//остальные поля в порядке таблицы коллекции
+        uint32_t fieldId = fields[i].fieldId;
+        if (fieldId != NO_FIELD && schema->name(fieldId) != "_id") {
+            json += ",";
+            JsonWriter::appendKey(json, schema->name(fieldId));
+            appendJsonValue(json, valueOf(fieldId, fields[i]), fields[i].container);
         }
     }
     json += "}";
     return json;
 }
 
+//внутрь заходим только в поле, сохраненное объектом или массивом, а не в похожую строку
+bool Document::nestedValue(const Vector<string>& path, string& value, bool& container) const {
+    if (!schema) {
+        return false;
+    }
+    int fieldId = schema->idOf(path[0]);
+    const FieldValue* stored = fieldAt(fieldId);
+    if (!stored || !stored->container) {
+        return false;
+    }
+    return JsonPath::lookup(valueOf(fieldId, *stored), path, 1, value, container);
+}
+
+bool Document::findPath(const Vector<string>& path, string& value, bool& container) const {
+    if (path.size() > 1) {
+        return nestedValue(path, value, container);
+    }
+    const FieldValue* stored = schema ? fieldAt(schema->idOf(path[0])) : nullptr;
+    if (!stored) {
+        return false;
+    }
+    value = valueOf(stored->fieldId, *stored);
+    container = stored->container;
+    return true;
+}
+
+bool Document::getPath(const Vector<string>& path, string& value) const {
+    bool container;
+    return findPath(path, value, container);
+}
+
+struct ProjectedField {
+    const Vector<string>* path;
+    string value;
+    bool container;
+};
+
+//поля с общим началом пути идут подряд и собираются в один вложенный объект
+static void appendProjectedMembers(string& json, const std::vector<ProjectedField>& fields,
+                                   size_t begin, size_t end, size_t depth, bool& first) {
+    size_t i = begin;
+    while (i < end) {
+        const string& name = (*fields[i].path)[depth];
+        size_t j = i + 1;
+        while (j < end && (*fields[j].path)[depth] == name) {
+            j++;
+        }
+        if (!first) {
+            json += ",";
+        }
+        first = false;
+        JsonWriter::appendKey(json, name);
+        if (fields[i].path->size() == depth + 1) {
+            appendJsonValue(json, fields[i].value, fields[i].container);//поле целиком включает и свои вложенные пути
+        } else {
+            json += "{";
+            bool innerFirst = true;
+            appendProjectedMembers(json, fields, i, j, depth + 1, innerFirst);
+            json += "}";
+        }
+        i = j;
+    }
+}
+
+string Document::to_json(const Projection& projection) const {
+    if (projection.empty()) {
+        return to_json();
+    }
+    std::vector<ProjectedField> found;
+    for (size_t i = 0; i < projection.paths.size(); i++) {
+        ProjectedField field;
+        field.path = &projection.paths[i];
+        if (findPath(projection.paths[i], field.value, field.container)) {
+            found.push_back(field);
+        }
+    }
+
+    string json = "{\"_id\":";
+    JsonWriter::appendQuoted(json, id);
+    bool first = false;
+    appendProjectedMembers(json, found, 0, found.size(), 0, first);
+    json += "}";
+    return json;
+}
+
 bool Document::likeMatch(const string& value, const string& pattern) const {
     const char* valueStr = value.c_str();
     const char* patternStr = pattern.c_str();
@@ -127,35 +530,66 @@ bool Document::compareValues(const string& actual, const string& expected, Condi
     }
 }
 
-bool Document::evaluateCondition(const QueryCondition& condition, const HashMap<string, string>& docData) const {
+bool Document::matchesValue(const QueryCondition& condition, const string& actual) const {
     switch (condition.type) {
         case ConditionType::EQUAL:
         case ConditionType::GREATER_THAN:
         case ConditionType::LESS_THAN:
-        case ConditionType::LIKE: {
-            string actualValue;
-            if (!docData.get(condition.field, actualValue)) {
-                return false;
-            }
-            return compareValues(actualValue, condition.value, condition.type);
-        }
+        case ConditionType::LIKE:
+            return compareValues(actual, condition.value, condition.type);
         
-        case ConditionType::IN: {
-            string actualValue;
-            if (!docData.get(condition.field, actualValue)) {
-                return false;
-            }
+        case ConditionType::REGEX:
+            return condition.regex && condition.regex->matches(actual);//без шаблона условие не проходит разбор
+        
+        case ConditionType::IN:
             for (size_t i = 0; i < condition.inValues.size(); i++) {
-                if (actualValue == condition.inValues[i]) {
+                if (actual == condition.inValues[i]) {
                     return true;//совпало
                 }
             }
             return false;//не нашли
+        
+        default:
+            return false;
+    }
+}
+
+bool Document::evaluateCondition(const QueryCondition& condition) const {
+    switch (condition.type) {
+        case ConditionType::EQUAL:
+        case ConditionType::GREATER_THAN:
+        case ConditionType::LESS_THAN:
+        case ConditionType::LIKE:
+        case ConditionType::REGEX:
+        case ConditionType::IN: {
+            int fieldId = condition.fieldId >= 0 || !schema ? condition.fieldId : schema->idOf(condition.field);
+            const FieldValue* stored = fieldAt(fieldId);
+            if (!stored) {
+                //вложенный объект разбираем, только когда условие его касается
+                string nested;
+                bool container;
+                return !condition.path.empty() && nestedValue(condition.path, nested, container) &&
+                       matchesValue(condition, nested);
+            }
+            if (condition.dictSlot >= 0 && stored->code != StringDictionary::NO_CODE) {
+                if (condition.type == ConditionType::EQUAL) {
+                    return stored->code == condition.code;//сравнение кодов вместо строк
+                }
+                if (condition.type == ConditionType::IN && condition.inCodes.size() == condition.inValues.size()) {
+                    for (size_t i = 0; i < condition.inCodes.size(); i++) {
+                        if (stored->code == condition.inCodes[i]) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+            }
+            return matchesValue(condition, valueOf(fieldId, *stored));
         }
         
         case ConditionType::AND: {
             for (size_t i = 0; i < condition.subConditions.size(); i++) {
-                if (!evaluateCondition(condition.subConditions[i], docData)) {
+                if (!evaluateCondition(condition.subConditions[i])) {
                     return false;
                 }
             }
@@ -164,7 +598,7 @@ bool Document::evaluateCondition(const QueryCondition& condition, const HashMap<
         
         case ConditionType::OR: {
             for (size_t i = 0; i < condition.subConditions.size(); i++) {
-                if (evaluateCondition(condition.subConditions[i], docData)) {
+                if (evaluateCondition(condition.subConditions[i])) {
                     return true;
                 }
             }
@@ -177,5 +611,5 @@ bool Document::evaluateCondition(const QueryCondition& condition, const HashMap<
 }
 
 bool Document::matchesCondition(const QueryCondition& condition) const {
-    return evaluateCondition(condition, data);
+    return evaluateCondition(condition);
 }
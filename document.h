@@ -3,33 +3,83 @@
 
 #include "HashMap.h"
 #include "QueryCondition.h"
+#include "update_spec.h"
+#include "field_table.h"
+#include "projection.h"
+#include "json_value.h"
 #include <string>
 #include <ctime>
 #include <cstdlib>
+#include <memory>
 using namespace std;
 
 class Document {
 private:
-    HashMap<string, string> data;
+    static const uint32_t NO_FIELD = 0xFFFFFFFFu;//пустая ячейка плотного массива
+    static const uint32_t SMALL_FIELDS = 16;//до стольких полей массив сжатый
+
+    struct FieldValue {
+        string value;
+        uint32_t code;//код словаря поля или NO_CODE, тогда значение в value
+        uint32_t fieldId;//номер поля в FieldTable или NO_FIELD
+        bool container;//объект или массив исходным текстом, иначе строка
+        FieldValue() : code(StringDictionary::NO_CODE), fieldId(NO_FIELD), container(false) {}
+    };
+
+    //сжатый режим: только заданные поля, отсортированы по fieldId, поиск двоичный;
+    //плотный режим: ячейка с индексом fieldId, как только полей больше SMALL_FIELDS
+    FieldValue* fields;//массив из пула таблицы
+    uint32_t fieldCount;
+    uint32_t fieldCapacity;
+    bool dense;
+    shared_ptr<FieldTable> schema;//общая для документов коллекции
     string id;
 
-    bool evaluateCondition(const QueryCondition& condition, const HashMap<string, string>& docData) const;
+    void reserveFields(size_t count);
+    void clearFields();
+    void releaseFields();//возвращает массив в пул, пока schema еще жива
+    void copyFields(const Document& other);
+    void makeDense(size_t minCount);
+    FieldValue* findField(int fieldId);
+
+    void assign(const HashMap<string, string>& dataMap);
+    void assign(const JsonValue& object);
+    void setField(const string& field, const string& value, bool container = false);
+    bool removeField(const string& field);
+    const FieldValue* fieldAt(int fieldId) const;
+    const string& valueOf(size_t fieldId, const FieldValue& field) const;
+    bool nestedValue(const Vector<string>& path, string& value, bool& container) const;
+    bool findPath(const Vector<string>& path, string& value, bool& container) const;
+    bool evaluateCondition(const QueryCondition& condition) const;
+    bool matchesValue(const QueryCondition& condition, const string& actual) const;
     bool compareValues(const string& actual, const string& expected, ConditionType op) const;
     bool likeMatch(const string& value, const string& pattern) const;
 
 public:
     Document();
     Document(const string& jsonStr);
-    Document(const HashMap<string, string>& dataMap, const string& docId = "");
-    Document(const Document& other) = default;
-    Document& operator=(const Document& other) = default;
-    Document(Document&& other) noexcept = default;
-    Document& operator=(Document&& other) noexcept = default;
+    Document(const HashMap<string, string>& dataMap, const string& docId = "",
+             const shared_ptr<FieldTable>& table = nullptr);
+    //поля прямо из разобранного объекта, без промежуточной HashMap; _id берется из docId
+    Document(const JsonValue& object, const string& docId, const shared_ptr<FieldTable>& table);
+    Document(const Document& other);
+    Document& operator=(const Document& other);
+    Document(Document&& other) noexcept;
+    Document& operator=(Document&& other) noexcept;
+    ~Document();
     string getId() const;
     void setData(const HashMap<string, string>& newData);
     HashMap<string, string> getData() const;
+    bool getField(const string& field, string& value) const;
+    bool applyUpdate(const UpdateSpec& spec);//true если документ изменился
+    bool getPath(const Vector<string>& path, string& value) const;//поле или путь во вложенный объект
     string to_json() const;
+    string to_json(const Projection& projection) const;
     bool matchesCondition(const QueryCondition& condition) const;
 };
 
+//сохраненный документ не меняется: выдачи и подписки держат ссылку, а обновление
+//собирает новую версию и подменяет ее в коллекции
+typedef shared_ptr<const Document> DocumentRef;
+
 #endif
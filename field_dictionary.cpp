@@ -0,0 +1,106 @@
+#include "field_dictionary.h"
+
+//поля SecurityEvent, у которых всего несколько разных значений
+static const char* const DEFAULT_DICTIONARY_FIELDS[] = {
+    "severity", "source", "event_type", "hostname", "agent_id"
+};
+
+StringDictionary::StringDictionary(size_t maxSize) : maxSize(maxSize) {}
+
+uint32_t StringDictionary::encode(const string& value) {
+    uint32_t code = NO_CODE;
+    if (codes.get(value, code)) {
+        return code;
+    }
+    if (values.size() >= maxSize) {
+        return NO_CODE;//значение останется строкой в документе
+    }
+    code = static_cast<uint32_t>(values.size());
+    values.push_back(value);
+    codes.put(value, code);
+    return code;
+}
+
+uint32_t StringDictionary::find(const string& value) const {
+    uint32_t code = NO_CODE;
+    codes.get(value, code);
+    return code;
+}
+
+const string& StringDictionary::decode(uint32_t code) const {
+    return values[code];
+}
+
+size_t StringDictionary::size() const {
+    return values.size();
+}
+
+FieldDictionaries::FieldDictionaries() {
+    for (size_t i = 0; i < sizeof(DEFAULT_DICTIONARY_FIELDS) / sizeof(DEFAULT_DICTIONARY_FIELDS[0]); i++) {
+        addField(DEFAULT_DICTIONARY_FIELDS[i]);
+    }
+}
+
+FieldDictionaries::~FieldDictionaries() {
+    for (size_t i = 0; i < dictionaries.size(); i++) {
+        delete dictionaries[i];
+    }
+}
+
+void FieldDictionaries::addField(const string& field) {
+    if (fieldSlots.contains(field)) {
+        return;
+    }
+    fieldSlots.put(field, fieldNames.size());
+    fieldNames.push_back(field);
+    dictionaries.push_back(new StringDictionary(MAX_DICTIONARY_SIZE));
+}
+
+int FieldDictionaries::slotOf(const string& field) const {
+    size_t slot = 0;
+    if (!fieldSlots.get(field, slot)) {
+        return -1;
+    }
+    return static_cast<int>(slot);
+}
+
+size_t FieldDictionaries::slotCount() const {
+    return fieldNames.size();
+}
+
+const string& FieldDictionaries::fieldName(size_t slot) const {
+    return fieldNames[slot];
+}
+
+StringDictionary& FieldDictionaries::dictionary(size_t slot) {
+    return *dictionaries[slot];
+}
+
+const StringDictionary& FieldDictionaries::dictionary(size_t slot) const {
+    return *dictionaries[slot];
+}
+
+void FieldDictionaries::compile(QueryCondition& condition) const {
+    for (size_t i = 0; i < condition.subConditions.size(); i++) {
+        compile(condition.subConditions[i]);
+    }
+    if (condition.type != ConditionType::EQUAL && condition.type != ConditionType::IN) {
+        return;
+    }
+
+    int slot = slotOf(condition.field);
+    if (slot < 0) {
+        return;
+    }
+    condition.dictSlot = slot;
+    //значения нет в словаре -> NO_CODE, с закодированным документом не совпадет
+    const StringDictionary& dict = dictionary(slot);
+    if (condition.type == ConditionType::EQUAL) {
+        condition.code = dict.find(condition.value);
+    } else {
+        condition.inCodes.clear();
+        for (size_t i = 0; i < condition.inValues.size(); i++) {
+            condition.inCodes.push_back(dict.find(condition.inValues[i]));
+        }
+    }
+}
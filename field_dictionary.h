@@ -0,0 +1,54 @@
+#ifndef FIELD_DICTIONARY_H
+#define FIELD_DICTIONARY_H
+
+#include "HashMap.h"
+#include "vector.h"
+#include "QueryCondition.h"
+#include <string>
+#include <cstdint>
+using namespace std;
+
+//словарь значений одного поля: строка <-> небольшой целый код
+class StringDictionary {
+private:
+    HashMap<string, uint32_t> codes;
+    Vector<string> values;
+    size_t maxSize;
+
+public:
+    static const uint32_t NO_CODE = 0xFFFFFFFF;
+
+    StringDictionary(size_t maxSize);
+    uint32_t encode(const string& value);//NO_CODE если словарь заполнен и значения в нем нет
+    uint32_t find(const string& value) const;
+    const string& decode(uint32_t code) const;
+    size_t size() const;
+};
+
+//словари коллекции для полей с небольшим числом различных значений
+class FieldDictionaries {
+private:
+    HashMap<string, size_t> fieldSlots;//поле -> номер слота кода в документе
+    Vector<string> fieldNames;
+    Vector<StringDictionary*> dictionaries;
+
+public:
+    static const size_t MAX_DICTIONARY_SIZE = 65536;
+
+    FieldDictionaries();
+    ~FieldDictionaries();
+    FieldDictionaries(const FieldDictionaries&) = delete;
+    FieldDictionaries& operator=(const FieldDictionaries&) = delete;
+
+    void addField(const string& field);
+    int slotOf(const string& field) const;//-1 если поле не кодируется
+    size_t slotCount() const;
+    const string& fieldName(size_t slot) const;
+    StringDictionary& dictionary(size_t slot);
+    const StringDictionary& dictionary(size_t slot) const;
+
+    //заменяет значения равенства и $in на коды, чтобы сравнивать целые числа
+    void compile(QueryCondition& condition) const;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "field_table.h"
+
+FieldTable::FieldTable() {
+    for (size_t slot = 0; slot < dicts.slotCount(); slot++) {
+        intern(dicts.fieldName(slot));
+    }
+}
+
+size_t FieldTable::intern(const string& name) {
+    size_t id = 0;
+    if (ids.get(name, id)) {
+        return id;
+    }
+    id = names.size();
+    ids.put(name, id);
+    names.push_back(name);
+    dictSlots.push_back(dicts.slotOf(name));
+    return id;
+}
+
+int FieldTable::idOf(const string& name) const {
+    size_t id = 0;
+    if (!ids.get(name, id)) {
+        return -1;
+    }
+    return static_cast<int>(id);
+}
+
+size_t FieldTable::size() const {
+    return names.size();
+}
+
+const string& FieldTable::name(size_t id) const {
+    return names[id];
+}
+
+int FieldTable::dictSlot(size_t id) const {
+    return dictSlots[id];
+}
+
+FieldDictionaries& FieldTable::dictionaries() {
+    return dicts;
+}
+
+const FieldDictionaries& FieldTable::dictionaries() const {
+    return dicts;
+}
+
+void FieldTable::compile(QueryCondition& condition) const {
+    if (!condition.subConditions.empty()) {//AND/OR
+        for (size_t i = 0; i < condition.subConditions.size(); i++) {
+            compile(condition.subConditions[i]);
+        }
+        return;
+    }
+    condition.fieldId = idOf(condition.field);
+    dicts.compile(condition);
+}
+
+SlabPool& FieldTable::pool() {
+    return storage;
+}
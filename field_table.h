@@ -0,0 +1,39 @@
+#ifndef FIELD_TABLE_H
+#define FIELD_TABLE_H
+
+#include "HashMap.h"
+#include "vector.h"
+#include "QueryCondition.h"
+#include "field_dictionary.h"
+#include "slab_pool.h"
+#include <string>
+using namespace std;
+
+//имена полей коллекции: имя -> номер, общая таблица для всех документов
+class FieldTable {
+private:
+    HashMap<string, size_t> ids;
+    Vector<string> names;
+    Vector<int> dictSlots;//номер словаря поля или -1
+    FieldDictionaries dicts;
+    SlabPool storage;//массивы полей документов коллекции, уходит вместе с последним из них
+
+public:
+    FieldTable();
+    FieldTable(const FieldTable&) = delete;
+    FieldTable& operator=(const FieldTable&) = delete;
+
+    size_t intern(const string& name);//добавляет поле, если его еще нет
+    int idOf(const string& name) const;//-1 если поле ни разу не встречалось
+    size_t size() const;
+    const string& name(size_t id) const;
+    int dictSlot(size_t id) const;
+    FieldDictionaries& dictionaries();
+    const FieldDictionaries& dictionaries() const;
+    SlabPool& pool();
+
+    //проставляет условиям номера полей и коды словарей
+    void compile(QueryCondition& condition) const;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "hyperloglog.h"
+#include <cmath>
+
+HyperLogLog::HyperLogLog(int precision) : precision(precision) {
+    if (this->precision < MIN_PRECISION) this->precision = MIN_PRECISION;
+    if (this->precision > MAX_PRECISION) this->precision = MAX_PRECISION;
+    size_t count = static_cast<size_t>(1) << this->precision;
+    for (size_t i = 0; i < count; i++) {
+        registers.push_back(0);
+    }
+}
+
+//FNV-1a с перемешиванием из MurmurHash3: старшие биты нужны равномерными
+uint64_t HyperLogLog::hashValue(const string& value) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < value.size(); i++) {
+        hash ^= static_cast<unsigned char>(value[i]);
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void HyperLogLog::add(const string& value) {
+    addHash(hashValue(value));
+}
+
+void HyperLogLog::addHash(uint64_t hash) {
+    size_t index = static_cast<size_t>(hash >> (64 - precision));
+    uint64_t rest = (hash << precision) | (static_cast<uint64_t>(1) << (precision - 1));//ограничитель
+    uint8_t rank = 1;
+    while ((rest & 0x8000000000000000ULL) == 0) {
+        rank++;
+        rest <<= 1;
+    }
+    if (rank > registers[index]) {
+        registers[index] = rank;
+    }
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision != precision) {
+        return false;
+    }
+    for (size_t i = 0; i < registers.size(); i++) {
+        if (other.registers[i] > registers[i]) {
+            registers[i] = other.registers[i];
+        }
+    }
+    return true;
+}
+
+uint64_t HyperLogLog::estimate() const {
+    double m = static_cast<double>(registers.size());
+    double alpha;
+    if (registers.size() == 16) alpha = 0.673;
+    else if (registers.size() == 32) alpha = 0.697;
+    else if (registers.size() == 64) alpha = 0.709;
+    else alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < registers.size(); i++) {
+        sum += std::ldexp(1.0, -registers[i]);
+        if (registers[i] == 0) zeros++;
+    }
+    double result = alpha * m * m / sum;
+    if (result <= 2.5 * m && zeros > 0) {//мало значений: линейный подсчет точнее
+        result = m * std::log(m / static_cast<double>(zeros));
+    }
+    return static_cast<uint64_t>(result + 0.5);
+}
+
+double HyperLogLog::standardError() const {
+    return 1.04 / std::sqrt(static_cast<double>(registers.size()));
+}
@@ -0,0 +1,33 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include "vector.h"
+#include <string>
+#include <cstdint>
+using namespace std;
+
+//приблизительное число различных значений: 2^precision байт памяти,
+//стандартная ошибка около 1.04 / sqrt(2^precision)
+class HyperLogLog {
+private:
+    Vector<uint8_t> registers;
+    int precision;
+
+public:
+    static const int MIN_PRECISION = 4;
+    static const int MAX_PRECISION = 16;
+    static const int DEFAULT_PRECISION = 14;
+
+    explicit HyperLogLog(int precision = DEFAULT_PRECISION);
+
+    void add(const string& value);
+    void addHash(uint64_t hash);
+    bool merge(const HyperLogLog& other);//false если точность разная
+    uint64_t estimate() const;
+    double standardError() const;
+    int getPrecision() const { return precision; }
+
+    static uint64_t hashValue(const string& value);
+};
+
+#endif
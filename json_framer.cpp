@@ -0,0 +1,104 @@
+#include "json_framer.h"
+#include "json_scan.h"
+
+JsonFramer::JsonFramer(size_t maxMessageSize)
+    : scanPos(0), messageStart(NO_MESSAGE), inString(false), broken(false),
+      maxMessageSize(maxMessageSize) {}
+
+void JsonFramer::feed(const char* data, size_t length) {
+    if (!broken) {
+        buffer.append(data, length);
+    }
+}
+
+//разобранное и отданное стирается, в буфере остается только начатое сообщение
+void JsonFramer::compact() {
+    size_t keep = messageStart == NO_MESSAGE ? scanPos : messageStart;
+    buffer.erase(0, keep);
+    scanPos -= keep;
+    if (messageStart != NO_MESSAGE) {
+        messageStart = 0;
+    }
+}
+
+JsonFrame JsonFramer::fail() {
+    buffer.clear();
+    scanPos = 0;
+    messageStart = NO_MESSAGE;
+    openers.clear();
+    inString = false;
+    broken = true;
+    return JsonFrame::INVALID;
+}
+
+JsonFrame JsonFramer::next(string& message) {
+    if (broken) {
+        return JsonFrame::INVALID;
+    }
+    const char* data = buffer.data();
+    size_t length = buffer.size();
+    while (scanPos < length) {
+        if (openers.empty()) {//между сообщениями
+            scanPos = JsonScan::skipWhitespace(data, scanPos, length);
+            if (scanPos >= length) {
+                break;
+            }
+            char c = data[scanPos];
+            if (c == '{' || c == '[') {
+                messageStart = scanPos++;
+                openers.push_back(c);
+                continue;
+            }
+            return fail();
+        }
+
+        scanPos = inString ? JsonScan::findQuoteOrEscape(data, scanPos, length)
+                           : JsonScan::findStructural(data, scanPos, length);
+        if (scanPos >= length) {
+            break;
+        }
+        char c = data[scanPos++];
+        if (inString) {
+            if (c == '"') {
+                inString = false;
+            } else if (scanPos < length) {
+                scanPos++;//экранированный символ
+            } else {
+                scanPos--;//'\\' последний в буфере, вернемся к нему со следующей частью
+                break;
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            openers.push_back(c);
+        } else {
+            if ((openers.back() == '{') != (c == '}')) {
+                return fail();//скобки не сошлись
+            }
+            openers.pop_back();
+            if (!openers.empty()) {
+                continue;
+            }
+            message.assign(data + messageStart, scanPos - messageStart);
+            messageStart = NO_MESSAGE;
+            return JsonFrame::MESSAGE;
+        }
+    }
+
+    if (messageStart != NO_MESSAGE && scanPos - messageStart > maxMessageSize) {
+        return fail();
+    }
+    compact();
+    return JsonFrame::NEED_MORE;
+}
+
+void JsonFramer::reset() {
+    buffer.clear();
+    scanPos = 0;
+    messageStart = NO_MESSAGE;
+    openers.clear();
+    inString = false;
+    broken = false;
+}
@@ -0,0 +1,41 @@
+#ifndef JSON_FRAMER_H
+#define JSON_FRAMER_H
+
+#include <string>
+#include <cstddef>
+using namespace std;
+
+enum class JsonFrame {
+    NEED_MORE,//целого сообщения пока нет, нужно дочитать из сокета
+    MESSAGE,
+    INVALID//мусор вне объекта, лишняя скобка или слишком длинное сообщение; дальше поток не читается
+};
+
+//делит поток байт из сокета на JSON-сообщения верхнего уровня (объект или массив).
+//состояние разбора сохраняется между вызовами, каждый байт просматривается один раз,
+//сколько бы частей ни пришло через recv. после INVALID граница следующего сообщения
+//неизвестна, поэтому framer больше ничего не отдает: соединение нужно закрыть или reset()
+class JsonFramer {
+private:
+    static const size_t NO_MESSAGE = static_cast<size_t>(-1);
+
+    string buffer;
+    size_t scanPos;//до этой позиции буфер уже разобран
+    size_t messageStart;//начало текущего сообщения или NO_MESSAGE
+    string openers;//стек открытых '{' и '['
+    bool inString;
+    bool broken;//был INVALID, входящие данные отбрасываются до reset()
+    size_t maxMessageSize;
+
+    void compact();
+    JsonFrame fail();
+
+public:
+    explicit JsonFramer(size_t maxMessageSize = 64 * 1024 * 1024);
+
+    void feed(const char* data, size_t length);
+    JsonFrame next(string& message);//вызывать, пока не вернет NEED_MORE или INVALID
+    void reset();//при переподключении: недочитанное от старого соединения не нужно
+};
+
+#endif
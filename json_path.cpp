@@ -0,0 +1,172 @@
+#include "json_path.h"
+#include <cctype>
+#include <cstdlib>
+
+void JsonPath::split(const string& path, Vector<string>& segments) {
+    size_t start = 0;
+    while (true) {
+        size_t dot = path.find('.', start);
+        if (dot == string::npos) {
+            segments.push_back(path.substr(start));
+            return;
+        }
+        segments.push_back(path.substr(start, dot - start));
+        start = dot + 1;
+    }
+}
+
+void JsonPath::skipWhitespace(const string& json, size_t& pos) {
+    while (pos < json.size() && isspace(static_cast<unsigned char>(json[pos]))) {
+        pos++;
+    }
+}
+
+//разэкранирование как в JsonParser, чтобы вложенные строки сравнивались так же, как верхнего уровня
+bool JsonPath::readString(const string& json, size_t& pos, string& out) {
+    if (pos >= json.size() || json[pos] != '"') {
+        return false;
+    }
+    pos++;
+    out.clear();
+    while (pos < json.size() && json[pos] != '"') {
+        char c = json[pos];
+        if (c == '\\' && pos + 1 < json.size()) {
+            pos++;
+            switch (json[pos]) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                default: c = json[pos]; break;
+            }
+        }
+        out += c;
+        pos++;
+    }
+    if (pos >= json.size()) {
+        return false;
+    }
+    pos++;
+    return true;
+}
+
+bool JsonPath::skipValue(const string& json, size_t& pos) {
+    if (pos >= json.size()) {
+        return false;
+    }
+    char c = json[pos];
+    if (c == '"') {
+        pos++;
+        while (pos < json.size() && json[pos] != '"') {
+            pos += json[pos] == '\\' ? 2 : 1;
+        }
+        if (pos >= json.size()) return false;
+        pos++;
+        return true;
+    }
+    if (c == '{' || c == '[') {
+        int depth = 0;
+        bool inString = false;
+        for (; pos < json.size(); pos++) {
+            char ch = json[pos];
+            if (inString) {
+                if (ch == '\\') pos++;
+                else if (ch == '"') inString = false;
+                continue;
+            }
+            if (ch == '"') inString = true;
+            else if (ch == '{' || ch == '[') depth++;
+            else if (ch == '}' || ch == ']') {
+                if (--depth == 0) {
+                    pos++;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    //число, true/false/null
+    while (pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' &&
+           !isspace(static_cast<unsigned char>(json[pos]))) {
+        pos++;
+    }
+    return true;
+}
+
+bool JsonPath::lookup(const string& json, const Vector<string>& segments, size_t first,
+                      string& value, bool& container) {
+    size_t pos = 0;
+    string key;
+    for (size_t i = first; i < segments.size(); i++) {
+        skipWhitespace(json, pos);
+        if (pos >= json.size()) {
+            return false;
+        }
+
+        if (json[pos] == '{') {
+            pos++;
+            bool found = false;
+            while (!found) {
+                skipWhitespace(json, pos);
+                if (!readString(json, pos, key)) {
+                    return false;//конец объекта или мусор
+                }
+                skipWhitespace(json, pos);
+                if (pos >= json.size() || json[pos] != ':') {
+                    return false;
+                }
+                pos++;
+                skipWhitespace(json, pos);
+                if (key == segments[i]) {
+                    found = true;
+                } else {
+                    if (!skipValue(json, pos)) return false;
+                    skipWhitespace(json, pos);
+                    if (pos >= json.size() || json[pos] != ',') {
+                        return false;
+                    }
+                    pos++;
+                }
+            }
+        } else if (json[pos] == '[') {
+            const string& segment = segments[i];
+            if (segment.empty() || segment.size() > 9) {
+                return false;
+            }
+            for (size_t j = 0; j < segment.size(); j++) {
+                if (!isdigit(static_cast<unsigned char>(segment[j]))) return false;
+            }
+            size_t index = static_cast<size_t>(atoi(segment.c_str()));
+            pos++;
+            for (size_t j = 0; j < index; j++) {
+                skipWhitespace(json, pos);
+                if (pos >= json.size() || json[pos] == ']' || !skipValue(json, pos)) return false;
+                skipWhitespace(json, pos);
+                if (pos >= json.size() || json[pos] != ',') {
+                    return false;
+                }
+                pos++;
+            }
+            skipWhitespace(json, pos);
+            if (pos >= json.size() || json[pos] == ']') {
+                return false;
+            }
+        } else {
+            return false;//путь уходит внутрь скалярного значения
+        }
+    }
+
+    skipWhitespace(json, pos);
+    if (pos < json.size() && json[pos] == '"') {
+        container = false;
+        return readString(json, pos, value);
+    }
+    container = pos < json.size() && (json[pos] == '{' || json[pos] == '[');
+    size_t start = pos;
+    if (!skipValue(json, pos)) {
+        return false;
+    }
+    value = json.substr(start, pos - start);
+    return true;
+}
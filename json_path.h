@@ -0,0 +1,24 @@
+#ifndef JSON_PATH_H
+#define JSON_PATH_H
+
+#include "vector.h"
+#include <string>
+using namespace std;
+
+//вложенные поля по пути "proc.pid" читаются прямо из текста объекта, без полного разбора
+class JsonPath {
+private:
+    static void skipWhitespace(const string& json, size_t& pos);
+    static bool readString(const string& json, size_t& pos, string& out);
+    static bool skipValue(const string& json, size_t& pos);
+
+public:
+    static void split(const string& path, Vector<string>& segments);
+    //ищет segments[first..] внутри json; строка возвращается без кавычек,
+    //объект, массив, число и литерал - исходным текстом; в массиве сегмент - индекс.
+    //container - найден объект или массив, такой текст пишется в ответ без кавычек
+    static bool lookup(const string& json, const Vector<string>& segments, size_t first,
+                       string& value, bool& container);
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include "json_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define JSON_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+const bool JsonScan::whitespaceTable[256] = {
+    false, false, false, false, false, false, false, false, false, true,  true,  true,  true,  true,  false, false,
+    false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false,
+    true
+};
+
+static bool isStructural(char c) {
+    return c == '"' || c == '{' || c == '}' || c == '[' || c == ']';
+}
+
+static size_t findQuoteOrEscapeScalar(const char* data, size_t from, size_t length) {
+    while (from < length && data[from] != '"' && data[from] != '\\') {
+        from++;
+    }
+    return from;
+}
+
+static size_t findStructuralScalar(const char* data, size_t from, size_t length) {
+    while (from < length && !isStructural(data[from])) {
+        from++;
+    }
+    return from;
+}
+
+static size_t skipWhitespaceScalar(const char* data, size_t from, size_t length) {
+    while (from < length && JsonScan::isWhitespace(data[from])) {
+        from++;
+    }
+    return from;
+}
+
+#ifdef JSON_SCAN_X86
+
+__attribute__((target("sse2")))
+static size_t findQuoteOrEscapeSse2(const char* data, size_t from, size_t length) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i escape = _mm_set1_epi8('\\');
+    for (; from + 16 <= length; from += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, escape)));
+        if (mask) {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    return findQuoteOrEscapeScalar(data, from, length);
+}
+
+__attribute__((target("sse2")))
+static size_t findStructuralSse2(const char* data, size_t from, size_t length) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i braceOpen = _mm_set1_epi8('{');
+    const __m128i braceClose = _mm_set1_epi8('}');
+    const __m128i bracketOpen = _mm_set1_epi8('[');
+    const __m128i bracketClose = _mm_set1_epi8(']');
+    for (; from + 16 <= length; from += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                       _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, braceOpen), _mm_cmpeq_epi8(chunk, braceClose)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, bracketOpen), _mm_cmpeq_epi8(chunk, bracketClose))));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask) {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    return findStructuralScalar(data, from, length);
+}
+
+//пробелы как у isspace: ' ' и диапазон \t..\r, он проверяется двумя сравнениями
+__attribute__((target("sse2")))
+static size_t skipWhitespaceSse2(const char* data, size_t from, size_t length) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i controlLow = _mm_set1_epi8('\t' - 1);
+    const __m128i controlHigh = _mm_set1_epi8('\r' + 1);
+    for (; from + 16 <= length; from += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+        __m128i control = _mm_and_si128(_mm_cmpgt_epi8(chunk, controlLow), _mm_cmplt_epi8(chunk, controlHigh));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), control)) ^ 0xFFFF;
+        if (mask) {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    return skipWhitespaceScalar(data, from, length);
+}
+
+__attribute__((target("avx2")))
+static size_t findQuoteOrEscapeAvx2(const char* data, size_t from, size_t length) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i escape = _mm256_set1_epi8('\\');
+    for (; from + 32 <= length; from += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + from));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, escape))));
+        if (mask) {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    _mm256_zeroupper();//хвост идет в SSE-код без VEX, иначе штраф за переход
+    return findQuoteOrEscapeSse2(data, from, length);
+}
+
+__attribute__((target("avx2")))
+static size_t findStructuralAvx2(const char* data, size_t from, size_t length) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i braceOpen = _mm256_set1_epi8('{');
+    const __m256i braceClose = _mm256_set1_epi8('}');
+    const __m256i bracketOpen = _mm256_set1_epi8('[');
+    const __m256i bracketClose = _mm256_set1_epi8(']');
+    for (; from + 32 <= length; from += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + from));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                       _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, braceOpen), _mm256_cmpeq_epi8(chunk, braceClose)),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(chunk, bracketOpen), _mm256_cmpeq_epi8(chunk, bracketClose))));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+        if (mask) {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    _mm256_zeroupper();
+    return findStructuralSse2(data, from, length);
+}
+
+__attribute__((target("avx2")))
+static size_t skipWhitespaceAvx2(const char* data, size_t from, size_t length) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i controlLow = _mm256_set1_epi8('\t' - 1);
+    const __m256i controlHigh = _mm256_set1_epi8('\r' + 1);
+    for (; from + 32 <= length; from += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + from));
+        __m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, controlLow), _mm256_cmpgt_epi8(controlHigh, chunk));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), control)));
+        if (mask) {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    _mm256_zeroupper();
+    return skipWhitespaceSse2(data, from, length);
+}
+
+#endif
+
+struct ScanFunctions {
+    size_t (*findQuoteOrEscape)(const char*, size_t, size_t);
+    size_t (*findStructural)(const char*, size_t, size_t);
+    size_t (*skipWhitespace)(const char*, size_t, size_t);
+    const char* name;
+};
+
+static ScanFunctions detectFunctions() {
+#ifdef JSON_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {findQuoteOrEscapeAvx2, findStructuralAvx2, skipWhitespaceAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {findQuoteOrEscapeSse2, findStructuralSse2, skipWhitespaceSse2, "sse2"};
+    }
+#endif
+    return {findQuoteOrEscapeScalar, findStructuralScalar, skipWhitespaceScalar, "scalar"};
+}
+
+static const ScanFunctions& functions() {
+    static const ScanFunctions selected = detectFunctions();
+    return selected;
+}
+
+size_t JsonScan::findQuoteOrEscape(const char* data, size_t from, size_t length) {
+    return functions().findQuoteOrEscape(data, from, length);
+}
+
+size_t JsonScan::findStructural(const char* data, size_t from, size_t length) {
+    return functions().findStructural(data, from, length);
+}
+
+size_t JsonScan::skipWhitespace(const char* data, size_t from, size_t length) {
+    return functions().skipWhitespace(data, from, length);
+}
+
+const char* JsonScan::implementation() {
+    return functions().name;
+}
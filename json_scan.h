@@ -0,0 +1,23 @@
+#ifndef JSON_SCAN_H
+#define JSON_SCAN_H
+
+#include <cstddef>
+using namespace std;
+
+//поиск служебных символов JSON по 16 (SSE2) или 32 (AVX2) байта за шаг;
+//набор команд выбирается при первом вызове, без x86 работает табличный вариант.
+//все функции возвращают индекс найденного символа или length, если его нет
+class JsonScan {
+public:
+    static size_t findQuoteOrEscape(const char* data, size_t from, size_t length);//'"' или '\\'
+    static size_t findStructural(const char* data, size_t from, size_t length);//'"' '{' '}' '[' ']'
+    static size_t skipWhitespace(const char* data, size_t from, size_t length);//первый не пробел
+
+    static bool isWhitespace(char c) { return whitespaceTable[static_cast<unsigned char>(c)]; }
+    static const char* implementation();//"avx2", "sse2" или "scalar"
+
+private:
+    static const bool whitespaceTable[256];
+};
+
+#endif
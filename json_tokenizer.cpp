@@ -0,0 +1,405 @@
+#include "json_tokenizer.h"
+#include "json_scan.h"
+#include <cctype>
+
+JsonTokenizer::JsonTokenizer(const char* data, size_t length)
+    : data(data), length(length), pos(0), closing(0) {}
+
+JsonTokenizer::JsonTokenizer(const JsonSpan& span)
+    : data(span.data), length(span.length), pos(0), closing(0) {}
+
+//обычно пробелов нет или один, длинные отступы пропускаются векторно
+void JsonTokenizer::skipWhitespace() {
+    if (pos < length && JsonScan::isWhitespace(data[pos])) {
+        pos = JsonScan::skipWhitespace(data, pos + 1, length);
+    }
+}
+
+void JsonTokenizer::skipToDelimiter() {
+    while (pos < length && data[pos] != ',' && data[pos] != closing) {
+        pos++;
+    }
+}
+
+//\uXXXX заменяется на '?', как и раньше в JsonParser
+bool JsonTokenizer::readString(JsonSpan& out, string& scratch) {
+    if (pos >= length || data[pos] != '"') {
+        return false;
+    }
+    size_t start = ++pos;
+    pos = JsonScan::findQuoteOrEscape(data, pos, length);
+    if (pos >= length || data[pos] == '"') {
+        out = JsonSpan(data + start, pos - start);//без escape - прямо из буфера
+        if (pos < length) {
+            pos++;
+        }
+        return true;
+    }
+
+    scratch.assign(data + start, pos - start);
+    while (pos < length && data[pos] != '"') {
+        if (data[pos] != '\\') {
+            size_t next = JsonScan::findQuoteOrEscape(data, pos, length);
+            scratch.append(data + pos, next - pos);
+            pos = next;
+            continue;
+        }
+        if (++pos >= length) {
+            break;
+        }
+        switch (data[pos]) {
+            case 'n': scratch += '\n'; break;
+            case 't': scratch += '\t'; break;
+            case 'r': scratch += '\r'; break;
+            case 'b': scratch += '\b'; break;
+            case 'f': scratch += '\f'; break;
+            case 'u':
+                for (int i = 0; i < 4 && pos + 1 < length && isxdigit(static_cast<unsigned char>(data[pos + 1])); i++) {
+                    pos++;
+                }
+                scratch += '?';
+                break;
+            default: scratch += data[pos]; break;
+        }
+        pos++;
+    }
+    if (pos < length) {
+        pos++;
+    }
+    out = JsonSpan(scratch.data(), scratch.size());
+    return true;
+}
+
+//пропускает объект или массив с учетом строк; false если он не закрыт до конца буфера
+bool JsonTokenizer::skipContainer() {
+    int depth = 0;
+    bool inString = false;
+    while (pos < length) {
+        //до следующего значимого символа пропускаем блоками
+        pos = inString ? JsonScan::findQuoteOrEscape(data, pos, length) : JsonScan::findStructural(data, pos, length);
+        if (pos >= length) {
+            break;
+        }
+        char c = data[pos++];
+        if (inString) {
+            if (c == '\\') {
+                pos++;
+            } else {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool JsonTokenizer::readValue(JsonSpan& value, JsonToken& type) {
+    if (pos >= length) {
+        return false;
+    }
+    char c = data[pos];
+    if (c == '"') {
+        type = JsonToken::STRING;
+        return readString(value, valueScratch);
+    }
+    size_t start = pos;
+    if (c == '{' || c == '[') {
+        type = c == '{' ? JsonToken::OBJECT : JsonToken::ARRAY;
+        if (!skipContainer()) {
+            return false;
+        }
+        value = JsonSpan(data + start, pos - start);
+        return true;
+    }
+
+    while (pos < length && data[pos] != ',' && data[pos] != '}' && data[pos] != ']' &&
+           !JsonScan::isWhitespace(data[pos])) {
+        pos++;
+    }
+    value = JsonSpan(data + start, pos - start);
+    if (value.length == 0) {
+        return false;
+    }
+    if (value.equals("true")) {
+        type = JsonToken::TRUE_VALUE;
+    } else if (value.equals("false")) {
+        type = JsonToken::FALSE_VALUE;
+    } else if (value.equals("null")) {
+        type = JsonToken::NULL_VALUE;
+    } else if (isNumber(value.data, value.length)) {
+        type = JsonToken::NUMBER;
+    } else {
+        type = JsonToken::BARE;
+    }
+    return true;
+}
+
+bool JsonTokenizer::begin(char open, char close) {
+    skipWhitespace();
+    if (pos >= length || data[pos] != open) {
+        return false;
+    }
+    pos++;
+    closing = close;
+    return true;
+}
+
+bool JsonTokenizer::beginObject() {
+    return begin('{', '}');
+}
+
+bool JsonTokenizer::beginArray() {
+    return begin('[', ']');
+}
+
+//некорректный член пропускается до следующей запятой, разбор продолжается
+bool JsonTokenizer::nextMember(JsonSpan& key, JsonSpan& value, JsonToken& type) {
+    while (closing) {
+        skipWhitespace();
+        if (pos >= length) {
+            closing = 0;
+            break;
+        }
+        if (data[pos] == closing) {
+            pos++;
+            closing = 0;
+            break;
+        }
+        if (data[pos] == ',') {
+            pos++;
+            continue;
+        }
+        if (!readString(key, keyScratch)) {
+            skipToDelimiter();
+            continue;
+        }
+        skipWhitespace();
+        if (pos >= length || data[pos] != ':') {
+            skipToDelimiter();
+            continue;
+        }
+        pos++;
+        skipWhitespace();
+        if (!readValue(value, type)) {
+            skipToDelimiter();
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool JsonTokenizer::nextElement(JsonSpan& value, JsonToken& type) {
+    while (closing) {
+        skipWhitespace();
+        if (pos >= length) {
+            closing = 0;
+            break;
+        }
+        if (data[pos] == closing) {
+            pos++;
+            closing = 0;
+            break;
+        }
+        if (data[pos] == ',') {
+            pos++;
+            continue;
+        }
+        if (!readValue(value, type)) {
+            if (pos < length && data[pos] != ',' && data[pos] != closing) {
+                pos++;
+            }
+            skipToDelimiter();
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool JsonTokenizer::readSingle(JsonSpan& value, JsonToken& type) {
+    skipWhitespace();
+    return readValue(value, type);
+}
+
+bool JsonTokenizer::isNumber(const char* text, size_t length) {
+    size_t i = 0;
+    if (i < length && (text[i] == '-' || text[i] == '+')) {
+        i++;
+    }
+    bool hasDigits = false;
+    while (i < length && isdigit(static_cast<unsigned char>(text[i]))) {
+        hasDigits = true;
+        i++;
+    }
+    if (i < length && text[i] == '.') {
+        i++;
+        while (i < length && isdigit(static_cast<unsigned char>(text[i]))) {
+            hasDigits = true;
+            i++;
+        }
+    }
+    if (!hasDigits) {
+        return false;
+    }
+    if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+        i++;
+        if (i < length && (text[i] == '+' || text[i] == '-')) {
+            i++;
+        }
+        bool hasExpDigits = false;
+        while (i < length && isdigit(static_cast<unsigned char>(text[i]))) {
+            hasExpDigits = true;
+            i++;
+        }
+        if (!hasExpDigits) {
+            return false;
+        }
+    }
+    return i == length;
+}
+
+//строка с '"' в pos: только допустимые escape и никаких управляющих символов
+static bool skipStrictString(const char* text, size_t length, size_t& pos) {
+    for (pos++; pos < length; pos++) {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+        if (c == '"') {
+            pos++;
+            return true;
+        }
+        if (c < 0x20) {
+            return false;
+        }
+        if (c != '\\') {
+            continue;
+        }
+        if (++pos >= length) {
+            return false;
+        }
+        if (text[pos] == 'u') {
+            for (int i = 0; i < 4; i++) {
+                if (++pos >= length || !isxdigit(static_cast<unsigned char>(text[pos]))) {
+                    return false;
+                }
+            }
+        } else if (text[pos] == '\0' || !strchr("\"\\/bfnrt", text[pos])) {
+            return false;
+        }
+    }
+    return false;
+}
+
+//-?(0|[1-9]d*)(.d+)?([eE][+-]?d+)?
+static bool skipStrictNumber(const char* text, size_t length, size_t& pos) {
+    auto digits = [&]() {
+        size_t start = pos;
+        while (pos < length && isdigit(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+        return pos > start;
+    };
+    if (pos < length && text[pos] == '-') {
+        pos++;
+    }
+    if (pos < length && text[pos] == '0') {
+        pos++;
+    } else if (!digits()) {
+        return false;
+    }
+    if (pos < length && text[pos] == '.') {
+        pos++;
+        if (!digits()) {
+            return false;
+        }
+    }
+    if (pos < length && (text[pos] == 'e' || text[pos] == 'E')) {
+        pos++;
+        if (pos < length && (text[pos] == '+' || text[pos] == '-')) {
+            pos++;
+        }
+        if (!digits()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//без рекурсии: открытые контейнеры в стеке, глубина не ограничена
+bool JsonTokenizer::isValid(const char* text, size_t length) {
+    string open;
+    size_t pos = JsonScan::skipWhitespace(text, 0, length);
+    auto readKey = [&]() {
+        if (pos >= length || text[pos] != '"' || !skipStrictString(text, length, pos)) {
+            return false;
+        }
+        pos = JsonScan::skipWhitespace(text, pos, length);
+        if (pos >= length || text[pos] != ':') {
+            return false;
+        }
+        pos = JsonScan::skipWhitespace(text, pos + 1, length);
+        return true;
+    };
+
+    while (true) {
+        //ожидается значение
+        if (pos >= length) {
+            return false;
+        }
+        char c = text[pos];
+        if (c == '{' || c == '[') {
+            pos = JsonScan::skipWhitespace(text, pos + 1, length);
+            if (pos < length && text[pos] == (c == '{' ? '}' : ']')) {
+                pos++;//пустой контейнер - законченное значение
+            } else {
+                open.push_back(c);
+                if (c == '{' && !readKey()) {
+                    return false;
+                }
+                continue;
+            }
+        } else if (c == '"') {
+            if (!skipStrictString(text, length, pos)) {
+                return false;
+            }
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            const char* literal = c == 't' ? "true" : (c == 'f' ? "false" : "null");
+            size_t literalLength = strlen(literal);
+            if (length - pos < literalLength || memcmp(text + pos, literal, literalLength) != 0) {
+                return false;
+            }
+            pos += literalLength;
+        } else if (!skipStrictNumber(text, length, pos)) {
+            return false;
+        }
+
+        //после значения: запятая, закрывающая скобка или конец текста
+        while (true) {
+            pos = JsonScan::skipWhitespace(text, pos, length);
+            if (open.empty()) {
+                return pos == length;
+            }
+            if (pos >= length) {
+                return false;
+            }
+            char d = text[pos++];
+            if (d == ',') {
+                pos = JsonScan::skipWhitespace(text, pos, length);
+                if (open.back() == '{' && !readKey()) {
+                    return false;
+                }
+                break;
+            }
+            if (d != (open.back() == '{' ? '}' : ']')) {
+                return false;
+            }
+            open.pop_back();
+        }
+    }
+}
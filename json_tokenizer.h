@@ -0,0 +1,70 @@
+#ifndef JSON_TOKENIZER_H
+#define JSON_TOKENIZER_H
+
+#include <string>
+#include <cstddef>
+#include <cstring>
+using namespace std;
+
+//участок входного буфера, без копирования
+struct JsonSpan {
+    const char* data;
+    size_t length;
+
+    JsonSpan() : data(nullptr), length(0) {}
+    JsonSpan(const char* d, size_t l) : data(d), length(l) {}
+
+    string str() const { return string(data, length); }
+    bool equals(const char* text) const {
+        return strlen(text) == length && memcmp(data, text, length) == 0;
+    }
+};
+
+enum class JsonToken {
+    STRING,//span уже без кавычек и разэкранирован
+    NUMBER,
+    TRUE_VALUE,
+    FALSE_VALUE,
+    NULL_VALUE,
+    OBJECT,//span - исходный текст объекта вместе со скобками
+    ARRAY,
+    BARE//значение без кавычек, не число и не литерал, например дата 2024-01-01T10:00:00
+};
+
+//потоковый разбор одного уровня объекта или массива: каждое событие - член или элемент
+//со span'ами в исходный буфер. вложенные контейнеры отдаются целиком, их можно разобрать
+//новым токенизатором по тому же span. копия делается только для строк с escape-
+//последовательностями, такой span живет до следующего вызова nextMember/nextElement
+class JsonTokenizer {
+private:
+    const char* data;
+    size_t length;
+    size_t pos;
+    char closing;//'}' или ']' открытого контейнера, 0 - контейнер не начат или закрыт
+    string keyScratch;
+    string valueScratch;
+
+    void skipWhitespace();
+    void skipToDelimiter();//к следующей запятой или концу контейнера
+    bool readString(JsonSpan& out, string& scratch);
+    bool skipContainer();
+    bool readValue(JsonSpan& value, JsonToken& type);
+    bool begin(char open, char close);
+
+public:
+    JsonTokenizer(const char* data, size_t length);
+    explicit JsonTokenizer(const JsonSpan& span);
+
+    bool beginObject();//false если на входе не объект
+    bool beginArray();
+    bool nextMember(JsonSpan& key, JsonSpan& value, JsonToken& type);//false в конце объекта
+    bool nextElement(JsonSpan& value, JsonToken& type);//false в конце массива
+    bool readSingle(JsonSpan& value, JsonToken& type);//одно значение верхнего уровня
+
+    static bool isNumber(const char* text, size_t length);
+    //строгая проверка по грамматике JSON, без пропусков и дат без кавычек, как у разбора выше:
+    //прошедший ее текст можно вставлять в ответ как есть
+    static bool isValid(const char* text, size_t length);
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "json_value.h"
+#include "JsonParser.h"
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+JsonType JsonValue::type() const {
+    return document ? document->nodes[index].type : JsonType::NULL_VALUE;
+}
+
+size_t JsonValue::size() const {
+    if (!document) {
+        return 0;
+    }
+    return document->nodes[index].childCount;
+}
+
+JsonValue JsonValue::operator[](size_t i) const {
+    if (i >= size()) {
+        return JsonValue();
+    }
+    return JsonValue(document, document->nodes[index].firstChild + static_cast<uint32_t>(i));
+}
+
+JsonValue JsonValue::get(const char* key) const {
+    if (!isObject()) {
+        return JsonValue();
+    }
+    for (size_t i = 0; i < size(); i++) {
+        JsonValue member = (*this)[i];
+        if (member.name().equals(key)) {
+            return member;
+        }
+    }
+    return JsonValue();
+}
+
+JsonSpan JsonValue::name() const {
+    if (!document) {
+        return JsonSpan();
+    }
+    const JsonDocument::Node& node = document->nodes[index];
+    return document->span(node.keyOffset, node.keyLength, node.keyDecoded);
+}
+
+JsonSpan JsonValue::text() const {
+    if (!document) {
+        return JsonSpan();
+    }
+    const JsonDocument::Node& node = document->nodes[index];
+    switch (node.type) {
+        case JsonType::NULL_VALUE:
+            return JsonSpan("null", 4);
+        case JsonType::BOOLEAN:
+            return node.number != 0 ? JsonSpan("true", 4) : JsonSpan("false", 5);
+        default:
+            return document->span(node.textOffset, node.textLength, node.textDecoded);
+    }
+}
+
+double JsonValue::number() const {
+    return document ? document->nodes[index].number : 0;
+}
+
+JsonSpan JsonDocument::span(uint32_t offset, uint32_t length, bool isDecoded) const {
+    return JsonSpan((isDecoded ? decoded.data() : source.data()) + offset, length);
+}
+
+//span токенизатора указывает либо в source, либо в его буфер для строк с escape - такие копируются
+void JsonDocument::place(const JsonSpan& span, uint32_t& offset, uint32_t& length, bool& isDecoded) {
+    const char* begin = source.data();
+    less_equal<const char*> notAfter;
+    isDecoded = !(notAfter(begin, span.data) && notAfter(span.data + span.length, begin + source.size()));
+    if (isDecoded) {
+        offset = static_cast<uint32_t>(decoded.size());
+        decoded.append(span.data, span.length);
+    } else {
+        offset = static_cast<uint32_t>(span.data - begin);
+    }
+    length = static_cast<uint32_t>(span.length);
+}
+
+bool JsonDocument::addNode(const JsonSpan* key, const JsonSpan& value, JsonToken token) {
+    Node node;
+    node.number = 0;
+    node.firstChild = 0;
+    node.childCount = 0;
+    node.keyOffset = 0;
+    node.keyLength = 0;
+    node.keyDecoded = false;
+    node.textOffset = 0;
+    node.textLength = 0;
+    node.textDecoded = false;
+    switch (token) {
+        case JsonToken::STRING: node.type = JsonType::STRING; break;
+        case JsonToken::NUMBER:
+            node.type = JsonType::NUMBER;
+            node.number = strtod(value.data, nullptr);//за числом в source всегда разделитель или '\0'
+            break;
+        case JsonToken::TRUE_VALUE: node.type = JsonType::BOOLEAN; node.number = 1; break;
+        case JsonToken::FALSE_VALUE: node.type = JsonType::BOOLEAN; break;
+        case JsonToken::NULL_VALUE: node.type = JsonType::NULL_VALUE; break;
+        case JsonToken::OBJECT: node.type = JsonType::OBJECT; break;
+        case JsonToken::ARRAY: node.type = JsonType::ARRAY; break;
+        case JsonToken::BARE: {
+            string date;//как в JsonParser: остается только дата без кавычек
+            if (!JsonParser::valueText(value, token, date)) {
+                return false;
+            }
+            node.type = JsonType::STRING;
+            break;
+        }
+    }
+    if (node.type != JsonType::BOOLEAN && node.type != JsonType::NULL_VALUE) {
+        place(value, node.textOffset, node.textLength, node.textDecoded);
+    }
+    if (key) {
+        place(*key, node.keyOffset, node.keyLength, node.keyDecoded);
+    }
+    nodes.push_back(node);
+    return true;
+}
+
+//потомки дописываются в конец массива подряд, их контейнеры раскроются позже
+void JsonDocument::expand(uint32_t index) {
+    JsonTokenizer tokenizer(source.data() + nodes[index].textOffset, nodes[index].textLength);
+    uint32_t first = static_cast<uint32_t>(nodes.size());
+    JsonSpan key;
+    JsonSpan value;
+    JsonToken token;
+    if (nodes[index].type == JsonType::OBJECT) {
+        tokenizer.beginObject();
+        while (tokenizer.nextMember(key, value, token)) {
+            addNode(&key, value, token);
+        }
+    } else {
+        tokenizer.beginArray();
+        while (tokenizer.nextElement(value, token)) {
+            addNode(nullptr, value, token);
+        }
+    }
+    nodes[index].firstChild = first;
+    nodes[index].childCount = static_cast<uint32_t>(nodes.size()) - first;
+}
+
+//дерево строится по уровням без рекурсии, глубина вложенности не ограничена стеком
+bool JsonDocument::parse(const char* data, size_t length) {
+    source.assign(data, length);
+    decoded.clear();
+    nodes.clear();
+
+    JsonTokenizer tokenizer(source.data(), source.size());
+    JsonSpan value;
+    JsonToken token;
+    if (!tokenizer.readSingle(value, token) || !addNode(nullptr, value, token)) {
+        nodes.clear();
+        return false;
+    }
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].type == JsonType::OBJECT || nodes[i].type == JsonType::ARRAY) {
+            expand(i);
+        }
+    }
+    return true;
+}
+
+bool JsonDocument::parse(const string& json) {
+    return parse(json.data(), json.size());
+}
+
+JsonValue JsonDocument::root() const {
+    return nodes.empty() ? JsonValue() : JsonValue(this, 0);
+}
@@ -0,0 +1,88 @@
+#ifndef JSON_VALUE_H
+#define JSON_VALUE_H
+
+#include "json_tokenizer.h"
+#include "vector.h"
+#include <string>
+#include <cstdint>
+using namespace std;
+
+enum class JsonType {
+    NULL_VALUE,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT
+};
+
+class JsonDocument;
+
+//узел разобранного документа; действителен, пока документ жив и не разобран заново
+class JsonValue {
+private:
+    const JsonDocument* document;
+    uint32_t index;
+
+public:
+    JsonValue() : document(nullptr), index(0) {}
+    JsonValue(const JsonDocument* document, uint32_t index) : document(document), index(index) {}
+
+    bool valid() const { return document != nullptr; }
+    JsonType type() const;
+    bool isNull() const { return type() == JsonType::NULL_VALUE; }
+    bool isBoolean() const { return type() == JsonType::BOOLEAN; }
+    bool isNumber() const { return type() == JsonType::NUMBER; }
+    bool isString() const { return type() == JsonType::STRING; }
+    bool isArray() const { return type() == JsonType::ARRAY; }
+    bool isObject() const { return type() == JsonType::OBJECT; }
+
+    size_t size() const;//элементов массива или членов объекта
+    JsonValue operator[](size_t i) const;//по порядку, у объекта тоже
+    JsonValue get(const char* key) const;//невалидный, если такого члена нет
+    JsonSpan name() const;//имя члена объекта
+
+    //строка без кавычек и escape, число как в исходнике, true/false/null,
+    //контейнер - исходным текстом: так значения хранят документы и JsonParser
+    JsonSpan text() const;
+    string str() const { return text().str(); }
+    double number() const;//для NUMBER, у BOOLEAN 1 или 0
+    bool boolean() const { return number() != 0; }
+};
+
+//дерево JSON в двух непрерывных буферах: узлы в одном массиве (потомки контейнера
+//лежат подряд), тексты - в копии входа, только строки с escape разворачиваются отдельно
+class JsonDocument {
+private:
+    friend class JsonValue;
+
+    struct Node {
+        JsonType type;
+        bool keyDecoded;//имя в decoded, иначе в source
+        bool textDecoded;
+        uint32_t keyOffset;
+        uint32_t keyLength;
+        uint32_t textOffset;
+        uint32_t textLength;
+        uint32_t firstChild;
+        uint32_t childCount;
+        double number;
+    };
+
+    string source;
+    string decoded;
+    Vector<Node> nodes;
+
+    void place(const JsonSpan& span, uint32_t& offset, uint32_t& length, bool& isDecoded);
+    bool addNode(const JsonSpan* key, const JsonSpan& value, JsonToken token);
+    void expand(uint32_t index);
+    JsonSpan span(uint32_t offset, uint32_t length, bool isDecoded) const;
+
+public:
+    bool parse(const char* data, size_t length);//false если на входе нет значения
+    bool parse(const string& json);
+    JsonValue root() const;//невалидный до успешного parse
+    size_t nodeCount() const { return nodes.size(); }
+};
+
+#endif
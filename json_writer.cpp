@@ -0,0 +1,89 @@
+#include "json_writer.h"
+#include <cmath>
+#include <cstring>
+
+const char JsonWriter::escapeTable[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0,   0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   '\\'
+};
+
+const char JsonWriter::hexDigits[17] = "0123456789abcdef";
+
+static const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+//цифры пишутся с конца по две за шаг, потом переносятся в начало буфера
+static size_t formatUnsigned(char* buffer, unsigned long long value) {
+    char digits[JsonWriter::INTEGER_DIGITS];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    while (value >= 100) {
+        unsigned pair = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = static_cast<unsigned>(value) * 2;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    size_t length = end - p;
+    memcpy(buffer, p, length);
+    return length;
+}
+
+size_t JsonWriter::formatInteger(char* buffer, long long value) {
+    if (value < 0) {
+        buffer[0] = '-';
+        return 1 + formatUnsigned(buffer + 1, 0ULL - static_cast<unsigned long long>(value));
+    }
+    return formatUnsigned(buffer, static_cast<unsigned long long>(value));
+}
+
+//NaN и бесконечность в JSON не записать, вместо них null
+size_t JsonWriter::formatFixed(char* buffer, double value, int decimals) {
+    if (!std::isfinite(value) || std::fabs(value) >= 9e18) {
+        memcpy(buffer, "null", 4);
+        return 4;
+    }
+    if (decimals < 0) {
+        decimals = 0;
+    } else if (decimals > 9) {
+        decimals = 9;
+    }
+    unsigned long long scale = 1;
+    for (int i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    if (std::fabs(value) * scale >= 9e18) {//дробная часть не помещается, пишем целое
+        return formatInteger(buffer, std::llround(value));
+    }
+
+    long long scaled = std::llround(value * scale);
+    size_t length = 0;
+    if (scaled < 0) {
+        buffer[length++] = '-';
+    }
+    unsigned long long magnitude = scaled < 0 ? 0ULL - static_cast<unsigned long long>(scaled)
+                                              : static_cast<unsigned long long>(scaled);
+    length += formatUnsigned(buffer + length, magnitude / scale);
+    if (decimals > 0) {
+        buffer[length++] = '.';
+        unsigned long long fraction = magnitude % scale;
+        for (int i = decimals - 1; i >= 0; i--) {
+            buffer[length + i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        length += decimals;
+    }
+    return length;
+}
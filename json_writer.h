@@ -0,0 +1,82 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <cstddef>
+using namespace std;
+
+//дописывает JSON в буфер вызывающего (string, ArenaString - все, у чего есть append(ptr, len)),
+//буфер можно очищать и переиспользовать между ответами. строки экранируются по таблице:
+//чистые участки копируются целиком, числа пишутся без sprintf и локали
+class JsonWriter {
+public:
+    static const size_t INTEGER_DIGITS = 24;//хватает на long long со знаком
+
+    template<typename Out>
+    static void appendEscaped(Out& out, const char* text, size_t length);
+    template<typename Out>
+    static void appendQuoted(Out& out, const string& text);//"text"
+    template<typename Out>
+    static void appendKey(Out& out, const string& name);//"name":
+    template<typename Out>
+    static void appendInteger(Out& out, long long value);
+    template<typename Out>
+    static void appendFixed(Out& out, double value, int decimals);//0.0163, decimals <= 9
+
+    static size_t formatInteger(char* buffer, long long value);//без завершающего нуля
+    static size_t formatFixed(char* buffer, double value, int decimals);//буфер на 48 символов
+
+private:
+    static const char escapeTable[256];//0 - как есть, 'u' - \u00XX, иначе буква после '\'
+    static const char hexDigits[17];
+};
+
+template<typename Out>
+void JsonWriter::appendEscaped(Out& out, const char* text, size_t length) {
+    size_t clean = 0;
+    for (size_t i = 0; i < length; i++) {
+        char kind = escapeTable[static_cast<unsigned char>(text[i])];
+        if (!kind) {
+            continue;
+        }
+        out.append(text + clean, i - clean);
+        if (kind == 'u') {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            char sequence[6] = {'\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 15]};
+            out.append(sequence, 6);
+        } else {
+            char sequence[2] = {'\\', kind};
+            out.append(sequence, 2);
+        }
+        clean = i + 1;
+    }
+    out.append(text + clean, length - clean);
+}
+
+template<typename Out>
+void JsonWriter::appendQuoted(Out& out, const string& text) {
+    out.append("\"", 1);
+    appendEscaped(out, text.data(), text.size());
+    out.append("\"", 1);
+}
+
+template<typename Out>
+void JsonWriter::appendKey(Out& out, const string& name) {
+    out.append("\"", 1);
+    appendEscaped(out, name.data(), name.size());
+    out.append("\":", 2);
+}
+
+template<typename Out>
+void JsonWriter::appendInteger(Out& out, long long value) {
+    char buffer[INTEGER_DIGITS];
+    out.append(buffer, formatInteger(buffer, value));
+}
+
+template<typename Out>
+void JsonWriter::appendFixed(Out& out, double value, int decimals) {
+    char buffer[48];
+    out.append(buffer, formatFixed(buffer, value, decimals));
+}
+
+#endif
@@ -1,271 +1,223 @@
 #include "network_protocol.h"
 #include "JsonParser.h"
-#include <sstream>
+#include "json_writer.h"
 #include <iostream>
 #include <algorithm> 
+#include <cstdlib>
 using namespace std;
 
 // Вспомогательная функция для экранирования строк JSON
 string escapeJsonString(const string& str) {
-    ostringstream escaped;
-    for (char c : str) {
-        switch (c) {
-            case '"':  escaped << "\\\""; break;
-            case '\\': escaped << "\\\\"; break;
-            case '\b': escaped << "\\b"; break;
-            case '\f': escaped << "\\f"; break;
-            case '\n': escaped << "\\n"; break;
-            case '\r': escaped << "\\r"; break;
-            case '\t': escaped << "\\t"; break;
-            default:   escaped << c; break;
+    string escaped;
+    escaped.reserve(str.size());
+    JsonWriter::appendEscaped(escaped, str.data(), str.size());
+    return escaped;
+}
+
+//флаги дописываются только для готового JSON, у элементов, добавленных напрямую в data, их нет
+static void addRawItem(Vector<string>& data, Vector<bool>& rawData, string& json) {
+    while (rawData.size() < data.size()) {
+        rawData.push_back(false);
+    }
+    rawData.push_back(true);
+    data.push_back(move(json));
+}
+
+//готовый JSON и объект или массив, который разбирается без ошибок, вставляются как есть, иначе - строкой
+template<typename Out>
+static void appendDataItem(Out& json, const string& item, bool raw) {
+    if (raw) {
+        json.append(item.data(), item.size());
+        return;
+    }
+    if (!item.empty() && 
+        ((item[0] == '{' && item[item.size()-1] == '}') ||
+         (item[0] == '[' && item[item.size()-1] == ']'))) {
+        
+        // Проверяем валидность JSON
+        JsonParser parser;
+        try {
+            if (item[0] == '{') {
+                HashMap<string, string> parsed = parser.parse(item);
+            } else {
+                Vector<HashMap<string, string>> parsed = parser.parseArray(item);
+            }
+            json.append(item.data(), item.size());
+            return;
+        } catch (...) {
+            // Если не парсится как JSON, обрабатываем как строку
         }
     }
-    return escaped.str();
+    JsonWriter::appendQuoted(json, item);
 }
 
-string Request::toJson() const {
-    ostringstream json;
-    json << "{";
-    json << "\"database\":\"" << database << "\",";
-    json << "\"operation\":\"" << operation << "\",";
-    json << "\"collection\":\"" << collection << "\",";
+template<typename Out>
+void Request::writeJson(Out& json) const {
+    json += "{\"database\":";
+    JsonWriter::appendQuoted(json, database);
+    json += ",\"operation\":";
+    JsonWriter::appendQuoted(json, operation);
+    json += ",\"collection\":";
+    JsonWriter::appendQuoted(json, collection);
+    json += ",";
     
     // query должен быть строкой или JSON объектом
     if (!query.empty()) {
-        json << "\"query\":";
+        json += "\"query\":";
         // Если query начинается с {, это JSON объект
         if (query[0] == '{' || query[0] == '[') {
-            json << query;
+            json.append(query.data(), query.size());
         } else {
-            json << "\"" << escapeJsonString(query) << "\"";
+            JsonWriter::appendQuoted(json, query);
         }
-        json << ",";
+        json += ",";
     }
     
-    json << "\"data\":[";
+    if (!handle.empty()) {
+        json += "\"handle\":";
+        JsonWriter::appendQuoted(json, handle);
+        json += ",";
+    }
+    
+    if (!projection.empty() && projection[0] == '{') {
+        json += "\"projection\":";
+        json.append(projection.data(), projection.size());
+        json += ",";
+    }
+    
+    json += "\"data\":[";
     for (size_t i = 0; i < data.size(); ++i) {
-        if (i > 0) json << ",";
-        
-        // Проверяем, является ли data[i] JSON объектом/массивом
-        if (!data[i].empty() && 
-            ((data[i][0] == '{' && data[i][data[i].size()-1] == '}') ||
-             (data[i][0] == '[' && data[i][data[i].size()-1] == ']'))) {
-            
-            // Проверяем валидность JSON
-            JsonParser parser;
-            try {
-                if (data[i][0] == '{') {
-                    HashMap<string, string> parsed = parser.parse(data[i]);
-                    json << data[i];  // Это валидный JSON объект
-                } else if (data[i][0] == '[') {
-                    Vector<HashMap<string, string>> parsed = parser.parseArray(data[i]);
-                    json << data[i];  // Это валидный JSON массив
-                }
-            } catch (...) {
-                // Если не парсится как JSON, обрабатываем как строку
-                json << "\"" << escapeJsonString(data[i]) << "\"";
-            }
-        } else {
-            // Это обычная строка, экранируем
-            json << "\"" << escapeJsonString(data[i]) << "\"";
-        }
+        if (i > 0) json += ",";
+        appendDataItem(json, data[i], i < rawData.size() && rawData[i]);
     }
-    json << "]}";
-    return json.str();
+    json += "]}";
 }
 
+template void Request::writeJson<string>(string& out) const;
+
+void Request::addRaw(string json) {
+    addRawItem(data, rawData, json);
+}
+
+string Request::toJson() const {
+    string json;
+    writeJson(json);
+    return json;
+}
+
+//поля запроса читаются прямо из span'ов, документы в data копируются исходным текстом
 Request Request::fromJson(const string& jsonStr) {    
     Request req;
-    JsonParser parser;
-    try {
-        HashMap<string, string> parsed = parser.parse(jsonStr);
-        string value;
-        
-        if (parsed.contains("database")) {
-            if (parsed.get("database", value)) {
-                req.database = value;
+    JsonTokenizer tokenizer(jsonStr.data(), jsonStr.size());
+    if (!tokenizer.beginObject()) {
+        return req;
+    }
+    JsonSpan key;
+    JsonSpan value;
+    JsonToken type;
+    while (tokenizer.nextMember(key, value, type)) {
+        if (key.equals("data")) {
+            if (type != JsonToken::ARRAY) {
+                continue;
             }
-        }
-        
-        if (parsed.contains("operation")) {
-            if (parsed.get("operation", value)) {
-                req.operation = value;
+            JsonTokenizer items(value);
+            items.beginArray();
+            JsonSpan item;
+            JsonToken itemType;
+            while (items.nextElement(item, itemType)) {
+                if (itemType == JsonToken::OBJECT) {//прочие элементы, как и раньше, пропускаются
+                    req.data.emplace_back(item.data, item.length);
+                }
             }
+            continue;
         }
         
-        if (parsed.contains("collection")) {
-            if (parsed.get("collection", value)) {
-                req.collection = value;
-            }
+        string* field = nullptr;
+        if (key.equals("database")) {
+            field = &req.database;
+        } else if (key.equals("operation")) {
+            field = &req.operation;
+        } else if (key.equals("collection")) {
+            field = &req.collection;
+        } else if (key.equals("query")) {
+            field = &req.query;
+        } else if (key.equals("handle")) {
+            field = &req.handle;
+        } else if (key.equals("projection")) {
+            field = &req.projection;
         }
-        
-        if (parsed.contains("query")) {
-            if (parsed.get("query", value)) {
-                req.query = value;
-            }
+        if (field) {
+            JsonParser::valueText(value, type, *field);
         }
-        
-        if (parsed.contains("data")) {
-            string dataStr;
-            if (parsed.get("data", dataStr)) {
-                if (dataStr.size() >= 2 && dataStr[0] == '[' && dataStr[dataStr.size()-1] == ']') {
-                    Vector<HashMap<string, string>> dataArray = parser.parseArray(dataStr);
-                    for (size_t i = 0; i < dataArray.size(); i++) {
-                        HashMap<string, string> item = dataArray[i];
-                        ostringstream itemJson;
-                        itemJson << "{";
-                        auto items = item.items();
-                        for (size_t j = 0; j < items.size(); j++) {
-                            if (j > 0) itemJson << ",";
-                            itemJson << "\"" << items[j].first << "\":";
-                            
-                            string val = items[j].second;
-                            if (val.empty() || 
-                                (val[0] != '{' && val[0] != '[' && 
-                                 val != "true" && val != "false" && val != "null" &&
-                                 !isdigit(val[0]) && val[0] != '-')) {
-                                itemJson << "\"" << val << "\"";
-                            } else {
-                                itemJson << val;
-                            }
-                        }
-                        itemJson << "}";
-                        req.data.push_back(itemJson.str());
-                    }
-                }
-            }
-        }
-    } catch (const exception& e) {
-        cerr << "[REQUEST][ERROR] Failed to parse JSON: " << e.what() << endl;
     }
-    
     return req;
 }
 
-string Response::toJson() const {
-    ostringstream json;
-    json << "{";
-    json << "\"status\":\"" << status << "\",";
-    json << "\"message\":\"" << escapeJsonString(message) << "\",";
-    json << "\"count\":" << count << ",";
-    json << "\"data\":[";
+template<typename Out>
+void Response::writeJson(Out& json) const {
+    json += "{\"status\":";
+    JsonWriter::appendQuoted(json, status);
+    json += ",\"message\":";
+    JsonWriter::appendQuoted(json, message);
+    json += ",\"count\":";
+    JsonWriter::appendInteger(json, count);
+    json += ",\"data\":[";
     for (size_t i = 0; i < data.size(); ++i) {
-        if (i > 0) json << ",";
-        
-        // Проверяем, является ли data[i] JSON объектом/массивом
-        if (!data[i].empty() && 
-            ((data[i][0] == '{' && data[i][data[i].size()-1] == '}') ||
-             (data[i][0] == '[' && data[i][data[i].size()-1] == ']'))) {
-            
-            // Проверяем валидность JSON
-            JsonParser parser;
-            try {
-                if (data[i][0] == '{') {
-                    HashMap<string, string> parsed = parser.parse(data[i]);
-                    json << data[i];  // Это валидный JSON объект
-                } else if (data[i][0] == '[') {
-                    Vector<HashMap<string, string>> parsed = parser.parseArray(data[i]);
-                    json << data[i];  // Это валидный JSON массив
-                }
-            } catch (...) {
-                // Если не парсится как JSON, обрабатываем как строку
-                json << "\"" << escapeJsonString(data[i]) << "\"";
-            }
-        } else {
-            // Это обычная строка, экранируем
-            json << "\"" << escapeJsonString(data[i]) << "\"";
-        }
+        if (i > 0) json += ",";
+        appendDataItem(json, data[i], i < rawData.size() && rawData[i]);
     }
-    json << "]}";
-    return json.str();
+    json += "]}";
+}
+
+void Response::addRaw(string json) {
+    addRawItem(data, rawData, json);
+}
+
+template void Response::writeJson<string>(string& out) const;
+template void Response::writeJson<ArenaString>(ArenaString& out) const;
+
+string Response::toJson() const {
+    string json;
+    writeJson(json);
+    return json;
 }
 
 Response Response::fromJson(const string& json) {
     Response resp;
-    JsonParser parser;
-    try {
-        HashMap<string, string> parsed = parser.parse(json);
-        
-        string value;
-        
-        if (parsed.contains("status")) {
-            if (parsed.get("status", value)) {
-                resp.status = value;
-            }
-        }
-        
-        if (parsed.contains("message")) {
-            if (parsed.get("message", value)) {
-                resp.message = value;
-            }
-        }
-        
-        if (parsed.contains("count")) {
+    resp.count = 0;
+    JsonTokenizer tokenizer(json.data(), json.size());
+    if (!tokenizer.beginObject()) {
+        return resp;
+    }
+    JsonSpan key;
+    JsonSpan value;
+    JsonToken type;
+    while (tokenizer.nextMember(key, value, type)) {
+        if (key.equals("status")) {
+            JsonParser::valueText(value, type, resp.status);
+        } else if (key.equals("message")) {
+            JsonParser::valueText(value, type, resp.message);
+        } else if (key.equals("count")) {
             string countStr;
-            if (parsed.get("count", countStr)) {
-                try {
-                    resp.count = stoi(countStr);
-                } catch (const exception& e) {
-                    cerr << "[RESPONSE][ERROR] Invalid count value: " << countStr << endl;
-                    resp.count = 0;
-                }
+            JsonParser::valueText(value, type, countStr);
+            try {
+                resp.count = stoi(countStr);
+            } catch (const exception& e) {
+                cerr << "[RESPONSE][ERROR] Invalid count value: " << countStr << endl;
+                resp.count = 0;
             }
-        }
-        
-        if (parsed.contains("data")) {
-            string dataStr;
-            if (parsed.get("data", dataStr)) {
-                if (dataStr.size() >= 2 && dataStr[0] == '[' && dataStr[dataStr.size()-1] == ']') {
-                    string extracted = parser.extractJsonValue(dataStr);
-                    if (!extracted.empty() && extracted[0] == '[') {
-                        size_t pos = 1;
-                        while (pos < extracted.length()) {
-                            while (pos < extracted.length() && isspace(extracted[pos])) pos++;
-                            
-                            if (extracted[pos] == ']') break;
-                            
-                            if (extracted[pos] == '"') {
-                                pos++;
-                                size_t start = pos;
-                                while (pos < extracted.length() && extracted[pos] != '"') {
-                                    if (extracted[pos] == '\\') pos++;
-                                    pos++;
-                                }
-                                if (pos < extracted.length()) {
-                                    string item = extracted.substr(start, pos - start);
-                                    resp.data.push_back(item);
-                                    pos++;
-                                }
-                            } else if (extracted[pos] == '{') {
-                                size_t start = pos;
-                                int braceCount = 0;
-                                do {
-                                    if (extracted[pos] == '{') braceCount++;
-                                    else if (extracted[pos] == '}') braceCount--;
-                                    pos++;
-                                } while (pos < extracted.length() && braceCount > 0);
-                                
-                                if (braceCount == 0) {
-                                    string item = extracted.substr(start, pos - start);
-                                    resp.data.push_back(item);
-                                }
-                            } else {
-                                pos++;
-                            }
-                            
-                            while (pos < extracted.length() && isspace(extracted[pos])) pos++;
-                            if (pos < extracted.length() && extracted[pos] == ',') pos++;
-                        }
-                    }
+        } else if (key.equals("data") && type == JsonToken::ARRAY) {
+            JsonTokenizer items(value);
+            items.beginArray();
+            JsonSpan item;
+            JsonToken itemType;
+            while (items.nextElement(item, itemType)) {
+                if (itemType == JsonToken::STRING || itemType == JsonToken::OBJECT) {
+                    resp.data.emplace_back(item.data, item.length);
                 }
             }
         }
-    } catch (const exception& e) {
-        cerr << "[RESPONSE][ERROR] Failed to parse JSON response: " << e.what() << endl;
-        resp.status = "error";
-        resp.message = "Failed to parse response: " + string(e.what());
     }
-    
     return resp;
 }
 
@@ -3,6 +3,7 @@
 
 #include "vector.h"
 #include "HashMap.h"
+#include "arena.h"
 #include <string>
 
 using namespace std;
@@ -14,9 +15,15 @@ struct Request {
     string operation;
     string collection;
     Vector<string> data;
+    Vector<bool> rawData;//rawData[i] - data[i] заведомо валидный JSON, копируется без проверки
     string query;
+    string handle;//идентификатор подготовленного запроса для execute
+    string projection;//поля ответа find, {"hostname":1,"proc.pid":1}
     
+    void addRaw(string json);//документ, собранный JsonWriter'ом или уже разобранный
     string toJson() const;
+    template<typename Out>
+    void writeJson(Out& out) const;
     static Request fromJson(const string& json);
 };
 
@@ -24,9 +31,14 @@ struct Response {
     string status;
     string message;
     Vector<string> data;
+    Vector<bool> rawData;//как в Request: остальные элементы перед записью проверяются разбором
     int count;
     
+    void addRaw(string json);
     string toJson() const;
+    //дописывает JSON в out: string или ArenaString запроса
+    template<typename Out>
+    void writeJson(Out& out) const;
     static Response fromJson(const string& json);
 };
 
@@ -71,22 +71,17 @@ Vector<SecurityEvent> PersistentBuffer::getBatch(size_t batch_size) {
     Vector<SecurityEvent> batch;
     
     size_t from_memory = min(batch_size, memory_buffer.size());//из памяти
+    batch.reserve(from_memory);
     for (size_t i = 0; i < from_memory; i++) {
-        batch.push_back(memory_buffer[i]);
-    }
-    
-    if (from_memory > 0) {//удаляем
-        Vector<SecurityEvent> new_buffer;
-        for (size_t i = from_memory; i < memory_buffer.size(); i++) {
-            new_buffer.push_back(memory_buffer[i]);
-        }
-        memory_buffer = new_buffer;
+        batch.push_back(std::move(memory_buffer[i]));
     }
+    memory_buffer.erase(0, from_memory);//остаток сдвигается на место отданных
     
     if (batch.size() < batch_size) {
         Vector<SecurityEvent> disk_events = loadFromDiskBatch(batch_size - batch.size());
+        batch.reserve(batch.size() + disk_events.size());
         for (size_t i = 0; i < disk_events.size(); i++) {
-            batch.push_back(disk_events[i]);
+            batch.push_back(std::move(disk_events[i]));
         }
     }
     
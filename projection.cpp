@@ -0,0 +1,55 @@
+#include "projection.h"
+#include "JsonParser.h"
+#include "json_path.h"
+#include <vector>
+#include <algorithm>
+
+Projection Projection::parse(const string& json) {
+    Projection projection;
+    if (json.empty()) {
+        return projection;
+    }
+
+    JsonParser parser;
+    HashMap<string, string> spec = parser.parse(json);
+    std::vector<std::vector<string>> sorted;
+    for (const auto& entry : spec) {
+        const string& value = entry.value;
+        if (entry.key == "_id" || value == "0" || value == "false") {
+            continue;
+        }
+        Vector<string> segments;
+        JsonPath::split(entry.key, segments);
+        std::vector<string> path;
+        for (size_t j = 0; j < segments.size(); j++) {
+            path.push_back(segments[j]);
+        }
+        sorted.push_back(path);
+    }
+    //по сегментам, а не по строке: пути с общим началом идут подряд
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+
+    for (size_t i = 0; i < sorted.size(); i++) {
+        Vector<string> path;
+        string field;
+        for (size_t j = 0; j < sorted[i].size(); j++) {
+            if (j > 0) field += '.';
+            field += sorted[i][j];
+            path.push_back(sorted[i][j]);
+        }
+        projection.fields.push_back(field);
+        projection.paths.push_back(path);
+    }
+    return projection;
+}
+
+string Projection::normalizedKey() const {
+    string key;
+    for (size_t i = 0; i < fields.size(); i++) {
+        key += to_string(fields[i].size());
+        key += ':';
+        key += fields[i];
+    }
+    return key;
+}
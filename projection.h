@@ -0,0 +1,19 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include "vector.h"
+#include <string>
+using namespace std;
+
+//поля, которые find возвращает в ответе; пустая проекция - документ целиком
+struct Projection {
+    Vector<string> fields;//отсортированы по сегментам, без _id (он есть всегда)
+    Vector<Vector<string>> paths;//те же поля, разбитые по точкам
+
+    bool empty() const { return fields.empty(); }
+    //{"hostname":1,"proc.pid":1}; поля со значением 0 или false пропускаются
+    static Projection parse(const string& json);
+    string normalizedKey() const;
+};
+
+#endif
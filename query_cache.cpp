@@ -0,0 +1,126 @@
+#include "query_cache.h"
+
+QueryCache::QueryCache(size_t maxEntries, size_t maxBytes)
+    : head(nullptr), tail(nullptr), maxEntries(maxEntries), maxBytes(maxBytes), usedBytes(0) {
+}
+
+QueryCache::~QueryCache() {
+    clear();
+}
+
+string QueryCache::makeKey(const string& database, const string& collection,
+                           const QueryCondition& condition, const Projection& projection) {
+    string key;
+    key += to_string(database.size());
+    key += ':';
+    key += database;
+    key += to_string(collection.size());
+    key += ':';
+    key += collection;
+    key += condition.normalizedKey();
+    if (!projection.empty()) {
+        key += '|';
+        key += projection.normalizedKey();
+    }
+    return key;
+}
+
+size_t QueryCache::entryBytes(const Entry* entry) const {
+    return sizeof(Entry) + entry->key.size() + entry->response.size();
+}
+
+void QueryCache::unlink(Entry* entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        tail = entry->prev;
+    }
+    entry->prev = nullptr;
+    entry->next = nullptr;
+}
+
+void QueryCache::pushFront(Entry* entry) {
+    entry->prev = nullptr;
+    entry->next = head;
+    if (head) {
+        head->prev = entry;
+    }
+    head = entry;
+    if (!tail) {
+        tail = entry;
+    }
+}
+
+void QueryCache::evict(Entry* entry) {
+    unlink(entry);
+    entries.remove(entry->key);
+    usedBytes -= entryBytes(entry);
+    delete entry;
+}
+
+bool QueryCache::get(const string& key, uint64_t version, string& response) {
+    lock_guard<mutex> lock(cacheMutex);
+    Entry* entry = nullptr;
+    if (!entries.get(key, entry)) {
+        return false;
+    }
+    if (entry->version != version) {//коллекция изменилась, ответ устарел
+        evict(entry);
+        return false;
+    }
+    unlink(entry);
+    pushFront(entry);
+    response = entry->response;
+    return true;
+}
+
+void QueryCache::put(const string& key, uint64_t version, const string& response) {
+    lock_guard<mutex> lock(cacheMutex);
+    if (maxEntries == 0 || sizeof(Entry) + key.size() + response.size() > maxBytes) {
+        return;//слишком большой ответ не кэшируем
+    }
+
+    Entry* existing = nullptr;
+    if (entries.get(key, existing)) {
+        evict(existing);
+    }
+
+    Entry* entry = new Entry();
+    entry->key = key;
+    entry->version = version;
+    entry->response = response;
+    entry->prev = nullptr;
+    entry->next = nullptr;
+
+    usedBytes += entryBytes(entry);
+    entries.put(key, entry);
+    pushFront(entry);
+
+    while (tail && (entries.size() > maxEntries || usedBytes > maxBytes)) {
+        evict(tail);
+    }
+}
+
+void QueryCache::clear() {
+    lock_guard<mutex> lock(cacheMutex);
+    Entry* entry = head;
+    while (entry) {
+        Entry* next = entry->next;
+        delete entry;
+        entry = next;
+    }
+    head = nullptr;
+    tail = nullptr;
+    entries.clear();
+    usedBytes = 0;
+}
+
+size_t QueryCache::size() {
+    lock_guard<mutex> lock(cacheMutex);
+    return entries.size();
+}
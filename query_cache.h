@@ -0,0 +1,51 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include "HashMap.h"
+#include "QueryCondition.h"
+#include "projection.h"
+#include <string>
+#include <mutex>
+#include <cstdint>
+using namespace std;
+
+//кэш сериализованных ответов find, LRU с ограничением по числу записей и байтам
+class QueryCache {
+private:
+    struct Entry {
+        string key;
+        uint64_t version;//версия коллекции на момент выполнения запроса
+        string response;
+        Entry* prev;
+        Entry* next;
+    };
+
+    HashMap<string, Entry*> entries;
+    Entry* head;//последний использованный
+    Entry* tail;//первый кандидат на вытеснение
+    size_t maxEntries;
+    size_t maxBytes;
+    size_t usedBytes;
+    mutex cacheMutex;
+
+    size_t entryBytes(const Entry* entry) const;
+    void unlink(Entry* entry);
+    void pushFront(Entry* entry);
+    void evict(Entry* entry);
+
+public:
+    QueryCache(size_t maxEntries = 1024, size_t maxBytes = 64 * 1024 * 1024);
+    ~QueryCache();
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
+
+    static string makeKey(const string& database, const string& collection,
+                          const QueryCondition& condition, const Projection& projection);
+
+    bool get(const string& key, uint64_t version, string& response);
+    void put(const string& key, uint64_t version, const string& response);
+    void clear();
+    size_t size();
+};
+
+#endif
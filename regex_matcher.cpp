@@ -0,0 +1,595 @@
+#include "regex_matcher.h"
+#include <algorithm>
+
+const int RegexMatcher::DEAD_STATE;
+
+RegexMatcher::RegexMatcher()
+    : nfaStart(-1), anchoredStart(false), anchoredEnd(false),
+      useDfa(false), dfaStart(DEAD_STATE), pattern(nullptr), pos(0) {}
+
+shared_ptr<const RegexMatcher> RegexMatcher::compile(const string& source, string& error) {
+    shared_ptr<RegexMatcher> matcher(new RegexMatcher());
+    string body = source;
+
+    //якоря только по краям шаблона
+    if (!body.empty() && body[0] == '^') {
+        matcher->anchoredStart = true;
+        body.erase(0, 1);
+    }
+    if (!body.empty() && body[body.size() - 1] == '$') {
+        size_t slashes = 0;
+        for (size_t i = body.size() - 1; i > 0 && body[i - 1] == '\\'; i--) {
+            slashes++;
+        }
+        if (slashes % 2 == 0) {
+            matcher->anchoredEnd = true;
+            body.erase(body.size() - 1);
+        }
+    }
+
+    matcher->pattern = &body;
+    matcher->pos = 0;
+    int root = matcher->parseAlternation(true);
+    if (matcher->error.empty() && matcher->pos < body.size()) {
+        matcher->error = "unexpected ')' at position " + to_string(matcher->pos);
+    }
+    matcher->pattern = nullptr;
+    if (!matcher->error.empty()) {
+        error = matcher->error;
+        return nullptr;
+    }
+
+    NfaState match;
+    match.kind = StateKind::MATCH;
+    matcher->nfa.push_back(match);
+    matcher->nfaStart = matcher->buildNfa(root, 0);
+    if (matcher->nfa.size() > MAX_NFA_STATES) {
+        error = "pattern is too large";
+        return nullptr;
+    }
+
+    string current;
+    matcher->appendRequired(root, current, matcher->prefilter);
+    if (current.size() > matcher->prefilter.size()) {
+        matcher->prefilter = current;
+    }
+    matcher->useDfa = matcher->buildDfa();
+    matcher->nodes.clear();//дерево после построения автомата не нужно
+    return matcher;
+}
+
+int RegexMatcher::addNode(NodeKind kind, int charset) {
+    Node node;
+    node.kind = kind;
+    node.charset = charset;
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size() - 1);
+}
+
+int RegexMatcher::addCharset(const bitset<256>& set) {
+    charsets.push_back(set);
+    return static_cast<int>(charsets.size() - 1);
+}
+
+int RegexMatcher::parseAlternation(bool topLevel) {
+    int first = parseConcat();
+    if (!error.empty() || pos >= pattern->size() || (*pattern)[pos] != '|') {
+        return first;
+    }
+    if (topLevel && (anchoredStart || anchoredEnd)) {//^a|b относится только к первой ветке
+        error = "anchors ^ and $ around top-level | need a group, e.g. ^(a|b)$";
+        return -1;
+    }
+    Vector<int> branches;
+    branches.push_back(first);
+    while (pos < pattern->size() && (*pattern)[pos] == '|') {
+        pos++;
+        int branch = parseConcat();
+        if (!error.empty()) return -1;
+        branches.push_back(branch);
+    }
+    int alt = addNode(NodeKind::ALT);
+    nodes[alt].children = branches;
+    return alt;
+}
+
+int RegexMatcher::parseConcat() {
+    Vector<int> parts;
+    while (pos < pattern->size() && (*pattern)[pos] != '|' && (*pattern)[pos] != ')') {
+        int part = parseRepeat();
+        if (!error.empty()) return -1;
+        parts.push_back(part);
+    }
+    if (parts.size() == 1) {
+        return parts[0];
+    }
+    int concat = addNode(parts.empty() ? NodeKind::EMPTY : NodeKind::CONCAT);
+    nodes[concat].children = parts;
+    return concat;
+}
+
+int RegexMatcher::parseRepeat() {
+    int atom = parseAtom();
+    if (!error.empty()) return -1;
+
+    while (pos < pattern->size()) {
+        char c = (*pattern)[pos];
+        int node = -1;
+        if (c == '*' || c == '+' || c == '?') {
+            pos++;
+            node = addNode(c == '*' ? NodeKind::STAR : (c == '+' ? NodeKind::PLUS : NodeKind::QUEST));
+            nodes[node].children.push_back(atom);
+        } else if (c == '{') {
+            //{n}, {n,}, {n,m}; иначе '{' обычный символ.
+            //цифры читаются все, а значение выше MAX_REPEAT дальше не растет и дает ошибку
+            size_t p = pos + 1;
+            int minCount = 0, maxCount = 0;
+            size_t digits = 0;
+            while (p < pattern->size() && isdigit((*pattern)[p])) {
+                if (minCount <= MAX_REPEAT) {
+                    minCount = minCount * 10 + ((*pattern)[p] - '0');
+                }
+                p++;
+                digits++;
+            }
+            if (digits == 0) break;
+            maxCount = minCount;
+            if (p < pattern->size() && (*pattern)[p] == ',') {
+                p++;
+                maxCount = -1;
+                if (p < pattern->size() && isdigit((*pattern)[p])) {
+                    maxCount = 0;
+                    while (p < pattern->size() && isdigit((*pattern)[p])) {
+                        if (maxCount <= MAX_REPEAT) {
+                            maxCount = maxCount * 10 + ((*pattern)[p] - '0');
+                        }
+                        p++;
+                    }
+                }
+            }
+            if (p >= pattern->size() || (*pattern)[p] != '}') break;
+            pos = p + 1;
+            if (minCount > MAX_REPEAT || maxCount > MAX_REPEAT || (maxCount >= 0 && maxCount < minCount)) {
+                error = "invalid repetition count";
+                return -1;
+            }
+            node = repeatNode(atom, minCount, maxCount);
+        } else {
+            break;
+        }
+        if (pos < pattern->size() && (*pattern)[pos] == '?') {
+            pos++;//ленивый квантификатор на факт совпадения не влияет
+        }
+        atom = node;
+    }
+    return atom;
+}
+
+int RegexMatcher::repeatNode(int child, int minCount, int maxCount) {
+    int concat = addNode(NodeKind::CONCAT);
+    for (int i = 0; i < minCount; i++) {
+        nodes[concat].children.push_back(child);
+    }
+    if (maxCount < 0) {
+        int star = addNode(NodeKind::STAR);
+        nodes[star].children.push_back(child);
+        nodes[concat].children.push_back(star);
+    } else {
+        for (int i = minCount; i < maxCount; i++) {
+            int quest = addNode(NodeKind::QUEST);
+            nodes[quest].children.push_back(child);
+            nodes[concat].children.push_back(quest);
+        }
+    }
+    if (nodes[concat].children.empty()) {
+        nodes[concat].kind = NodeKind::EMPTY;
+    }
+    return concat;
+}
+
+int RegexMatcher::parseAtom() {
+    char c = (*pattern)[pos];
+    bitset<256> set;
+    switch (c) {
+        case '(': {
+            pos++;
+            if (pos + 1 < pattern->size() && (*pattern)[pos] == '?' && (*pattern)[pos + 1] == ':') {
+                pos += 2;
+            }
+            int inner = parseAlternation();
+            if (!error.empty()) return -1;
+            if (pos >= pattern->size() || (*pattern)[pos] != ')') {
+                error = "missing ')'";
+                return -1;
+            }
+            pos++;
+            return inner;
+        }
+        case '[':
+            pos++;
+            return parseClass();
+        case '.':
+            pos++;
+            set.set();
+            set.reset('\n');
+            return addNode(NodeKind::CHARSET, addCharset(set));
+        case '\\':
+            pos++;
+            if (!parseEscape(set)) return -1;
+            return addNode(NodeKind::CHARSET, addCharset(set));
+        case '*':
+        case '+':
+        case '?':
+            error = string("nothing to repeat before '") + c + "'";
+            return -1;
+        case '^':
+        case '$':
+            error = "anchors ^ and $ are supported only at pattern boundaries";
+            return -1;
+        default:
+            pos++;
+            set.set(static_cast<unsigned char>(c));
+            return addNode(NodeKind::CHARSET, addCharset(set));
+    }
+}
+
+bool RegexMatcher::parseEscape(bitset<256>& set) {
+    if (pos >= pattern->size()) {
+        error = "trailing backslash";
+        return false;
+    }
+    char c = (*pattern)[pos++];
+    bitset<256> group;
+    switch (c) {
+        case 'd': case 'D':
+            for (int i = '0'; i <= '9'; i++) group.set(i);
+            break;
+        case 'w': case 'W':
+            for (int i = 0; i < 256; i++) {
+                if (isalnum(i) || i == '_') group.set(i);
+            }
+            break;
+        case 's': case 'S':
+            group.set(' '); group.set('\t'); group.set('\n');
+            group.set('\r'); group.set('\f'); group.set('\v');
+            break;
+        case 'n': set.set('\n'); return true;
+        case 't': set.set('\t'); return true;
+        case 'r': set.set('\r'); return true;
+        default:
+            set.set(static_cast<unsigned char>(c));
+            return true;
+    }
+    if (isupper(c)) {
+        group.flip();
+    }
+    set |= group;
+    return true;
+}
+
+int RegexMatcher::parseClass() {
+    bitset<256> set;
+    bool negate = false;
+    if (pos < pattern->size() && (*pattern)[pos] == '^') {
+        negate = true;
+        pos++;
+    }
+    bool first = true;
+    while (pos < pattern->size() && ((*pattern)[pos] != ']' || first)) {
+        first = false;
+        unsigned char low = static_cast<unsigned char>((*pattern)[pos]);
+        if (low == '\\') {
+            pos++;
+            bitset<256> escaped;
+            if (!parseEscape(escaped)) return -1;
+            if (escaped.count() != 1) {//\d, \w, \s внутри класса
+                set |= escaped;
+                continue;
+            }
+            for (int i = 0; i < 256; i++) {
+                if (escaped.test(i)) low = static_cast<unsigned char>(i);
+            }
+        } else {
+            pos++;
+        }
+
+        if (pos + 1 < pattern->size() && (*pattern)[pos] == '-' && (*pattern)[pos + 1] != ']') {
+            unsigned char high = static_cast<unsigned char>((*pattern)[pos + 1]);
+            pos += 2;
+            if (high == '\\' ) {
+                bitset<256> escaped;
+                if (!parseEscape(escaped) || escaped.count() != 1) {
+                    error = "invalid range in character class";
+                    return -1;
+                }
+                for (int i = 0; i < 256; i++) {
+                    if (escaped.test(i)) high = static_cast<unsigned char>(i);
+                }
+            }
+            if (high < low) {
+                error = "invalid range in character class";
+                return -1;
+            }
+            for (int i = low; i <= high; i++) set.set(i);
+        } else {
+            set.set(low);
+        }
+    }
+    if (pos >= pattern->size()) {
+        error = "missing ']'";
+        return -1;
+    }
+    pos++;
+    if (negate) {
+        set.flip();
+    }
+    return addNode(NodeKind::CHARSET, addCharset(set));
+}
+
+//строим НКА Томпсона с конца: next - куда перейти после совпадения узла
+int RegexMatcher::buildNfa(int node, int next) {
+    if (nfa.size() > MAX_NFA_STATES) {
+        return next;//дальше не строим, compile вернет ошибку
+    }
+    const Node& current = nodes[node];
+    switch (current.kind) {
+        case NodeKind::CHARSET: {
+            NfaState state;
+            state.kind = StateKind::CHARSET;
+            state.charset = current.charset;
+            state.out = next;
+            nfa.push_back(state);
+            return static_cast<int>(nfa.size() - 1);
+        }
+        case NodeKind::CONCAT: {
+            int start = next;
+            for (size_t i = current.children.size(); i > 0; i--) {
+                start = buildNfa(nodes[node].children[i - 1], start);
+            }
+            return start;
+        }
+        case NodeKind::ALT: {
+            Vector<int> starts;
+            for (size_t i = 0; i < nodes[node].children.size(); i++) {
+                starts.push_back(buildNfa(nodes[node].children[i], next));
+            }
+            int start = starts[starts.size() - 1];
+            for (size_t i = starts.size() - 1; i > 0; i--) {
+                NfaState split;
+                split.kind = StateKind::SPLIT;
+                split.out = starts[i - 1];
+                split.out1 = start;
+                nfa.push_back(split);
+                start = static_cast<int>(nfa.size() - 1);
+            }
+            return start;
+        }
+        case NodeKind::STAR:
+        case NodeKind::PLUS: {
+            NodeKind kind = current.kind;
+            int child = current.children[0];
+            NfaState split;
+            split.kind = StateKind::SPLIT;
+            split.out1 = next;
+            nfa.push_back(split);
+            int loop = static_cast<int>(nfa.size() - 1);
+            int body = buildNfa(child, loop);
+            nfa[loop].out = body;
+            return kind == NodeKind::STAR ? loop : body;
+        }
+        case NodeKind::QUEST: {
+            int body = buildNfa(current.children[0], next);
+            NfaState split;
+            split.kind = StateKind::SPLIT;
+            split.out = body;
+            split.out1 = next;
+            nfa.push_back(split);
+            return static_cast<int>(nfa.size() - 1);
+        }
+        case NodeKind::EMPTY:
+        default:
+            return next;
+    }
+}
+
+//самая длинная цепочка обязательных символов подряд
+void RegexMatcher::appendRequired(int node, string& current, string& best) const {
+    const Node& n = nodes[node];
+    if (n.kind == NodeKind::CHARSET && charsets[n.charset].count() == 1) {
+        for (int i = 0; i < 256; i++) {
+            if (charsets[n.charset].test(i)) current += static_cast<char>(i);
+        }
+        return;
+    }
+    if (n.kind == NodeKind::CONCAT) {
+        for (size_t i = 0; i < n.children.size(); i++) {
+            appendRequired(n.children[i], current, best);
+        }
+        return;
+    }
+    if (n.kind == NodeKind::EMPTY) {
+        return;
+    }
+
+    //x+ : x обязателен, но после него цепочка прерывается
+    string tail;
+    if (n.kind == NodeKind::PLUS) {
+        string inner;
+        string innerBest;
+        appendRequired(n.children[0], inner, innerBest);
+        if (innerBest.empty() && inner.size() == 1) {
+            current += inner;
+            tail = inner;
+        }
+    }
+    if (current.size() > best.size()) {
+        best = current;
+    }
+    current = tail;
+}
+
+void RegexMatcher::NfaScratch::nextGeneration() {
+    if (++generation == 0) {//счетчик обернулся, старые метки могли бы совпасть
+        std::fill(seen.begin(), seen.end(), 0);
+        generation = 1;
+    }
+}
+
+//состояния, помеченные текущим поколением scratch, повторно не добавляются
+void RegexMatcher::closure(int state, NfaScratch& scratch, std::vector<int>& states) const {
+    std::vector<int>& stack = scratch.stack;
+    stack.push_back(state);
+    while (!stack.empty()) {
+        int s = stack.back();
+        stack.pop_back();
+        if (scratch.seen[s] == scratch.generation) continue;
+        scratch.seen[s] = scratch.generation;
+        if (nfa[s].kind == StateKind::SPLIT) {
+            stack.push_back(nfa[s].out1);
+            stack.push_back(nfa[s].out);
+        } else {
+            states.push_back(s);
+        }
+    }
+}
+
+void RegexMatcher::step(const std::vector<int>& from, unsigned char c, std::vector<int>& to,
+                        NfaScratch& scratch) const {
+    scratch.nextGeneration();
+    to.clear();
+    for (size_t i = 0; i < from.size(); i++) {
+        const NfaState& s = nfa[from[i]];
+        if (s.kind == StateKind::CHARSET && charsets[s.charset].test(c)) {
+            closure(s.out, scratch, to);
+        }
+    }
+    if (!anchoredStart) {//совпадение может начаться в любой позиции
+        closure(nfaStart, scratch, to);
+    }
+}
+
+bool RegexMatcher::containsMatch(const std::vector<int>& states) const {
+    for (size_t i = 0; i < states.size(); i++) {
+        if (nfa[states[i]].kind == StateKind::MATCH) return true;
+    }
+    return false;
+}
+
+//построение ДКА подмножествами; false если состояний или работы слишком много:
+//каждое состояние ДКА стоит 256 шагов по своему множеству, а шаблон приходит от клиента
+bool RegexMatcher::buildDfa() {
+    HashMap<string, int> ids;
+    std::vector<std::vector<int>> sets;
+
+    NfaScratch scratch(nfa.size());
+    scratch.nextGeneration();
+    std::vector<int> start;
+    closure(nfaStart, scratch, start);
+    std::sort(start.begin(), start.end());
+
+    auto keyOf = [](const std::vector<int>& set) {
+        string key;
+        key.append(reinterpret_cast<const char*>(set.data()), set.size() * sizeof(int));
+        return key;
+    };
+    ids.put(keyOf(start), 0);
+    sets.push_back(start);
+    dfaStart = 0;
+
+    std::vector<int> next;
+    size_t work = 0;
+    for (size_t current = 0; current < sets.size(); current++) {
+        work += 256 * (sets[current].size() + (anchoredStart ? 0 : start.size()));
+        if (work > MAX_DFA_WORK) {
+            transitions.clear();
+            accepting.clear();
+            return false;
+        }
+        accepting.push_back(containsMatch(sets[current]));
+        for (int c = 0; c < 256; c++) {
+            step(sets[current], static_cast<unsigned char>(c), next, scratch);
+            std::sort(next.begin(), next.end());//ключ множества не зависит от порядка обхода
+            if (next.empty()) {
+                transitions.push_back(DEAD_STATE);
+                continue;
+            }
+            string key = keyOf(next);
+            int id = 0;
+            if (!ids.get(key, id)) {
+                if (sets.size() >= MAX_DFA_STATES) {
+                    transitions.clear();
+                    accepting.clear();
+                    return false;
+                }
+                id = static_cast<int>(sets.size());
+                ids.put(key, id);
+                sets.push_back(next);
+            }
+            transitions.push_back(id);
+        }
+    }
+    return true;
+}
+
+bool RegexMatcher::matchNfa(const string& text) const {
+    NfaScratch scratch(nfa.size());
+    scratch.nextGeneration();
+    std::vector<int> current;
+    std::vector<int> next;
+    closure(nfaStart, scratch, current);
+    for (size_t i = 0; i < text.size(); i++) {
+        if (!anchoredEnd && containsMatch(current)) return true;
+        if (current.empty()) return false;
+        step(current, static_cast<unsigned char>(text[i]), next, scratch);
+        current.swap(next);
+    }
+    return containsMatch(current);
+}
+
+bool RegexMatcher::matches(const string& text) const {
+    if (!prefilter.empty() && text.find(prefilter) == string::npos) {
+        return false;//дешевая проверка до автомата
+    }
+    if (!useDfa) {
+        return matchNfa(text);
+    }
+
+    int state = dfaStart;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (!anchoredEnd && accepting[state]) return true;
+        state = transitions[static_cast<size_t>(state) * 256 + static_cast<unsigned char>(text[i])];
+        if (state == DEAD_STATE) return false;
+    }
+    return accepting[state];
+}
+
+RegexCache& RegexCache::instance() {
+    static RegexCache cache;
+    return cache;
+}
+
+//компиляция с построением ДКА идет без блокировки, чтобы не задерживать запросы с другими шаблонами
+shared_ptr<const RegexMatcher> RegexCache::get(const string& pattern, string& error) {
+    shared_ptr<const RegexMatcher> matcher;
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        if (patterns.get(pattern, matcher)) {
+            return matcher;
+        }
+    }
+    matcher = RegexMatcher::compile(pattern, error);
+    if (!matcher) {
+        return nullptr;
+    }
+
+    lock_guard<mutex> lock(cacheMutex);
+    shared_ptr<const RegexMatcher> existing;
+    if (patterns.get(pattern, existing)) {
+        return existing;//тот же шаблон успел скомпилировать другой поток
+    }
+    if (patterns.size() >= MAX_PATTERNS) {
+        patterns = HashMap<string, shared_ptr<const RegexMatcher>>();//редко: просто начинаем заново
+    }
+    patterns.put(pattern, matcher);
+    return matcher;
+}
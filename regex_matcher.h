@@ -0,0 +1,110 @@
+#ifndef REGEX_MATCHER_H
+#define REGEX_MATCHER_H
+
+#include "HashMap.h"
+#include "vector.h"
+#include <string>
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+//регулярное выражение, скомпилированное в ДКА: поиск за один проход по строке
+//синтаксис: . [] [^] \d \w \s * + ? {n,m} | () и якоря ^ в начале, $ в конце;
+//при | на верхнем уровне якоря берутся только вместе с группой: ^(a|b)$
+class RegexMatcher {
+private:
+    enum class NodeKind { CHARSET, CONCAT, ALT, STAR, PLUS, QUEST, EMPTY };
+    struct Node {
+        NodeKind kind;
+        int charset;
+        Vector<int> children;
+        Node() : kind(NodeKind::EMPTY), charset(-1) {}
+    };
+
+    enum class StateKind { CHARSET, SPLIT, MATCH };
+    struct NfaState {
+        StateKind kind;
+        int charset;
+        int out;
+        int out1;
+        NfaState() : kind(StateKind::MATCH), charset(-1), out(-1), out1(-1) {}
+    };
+
+    //рабочие буферы обхода НКА на одно сопоставление: посещенные состояния помечаются
+    //номером поколения, так что на каждом байте массив не выделяется и не обнуляется
+    struct NfaScratch {
+        std::vector<uint32_t> seen;
+        uint32_t generation;
+        std::vector<int> stack;
+        explicit NfaScratch(size_t states) : seen(states, 0), generation(0) {}
+        void nextGeneration();
+    };
+
+    static const int DEAD_STATE = -1;
+    static const size_t MAX_DFA_STATES = 1024;//больше - работаем по НКА, тоже линейно
+    static const size_t MAX_DFA_WORK = 1 << 22;//обходов состояний НКА на построение ДКА
+    static const size_t MAX_NFA_STATES = 100000;
+    static const int MAX_REPEAT = 1000;
+
+    Vector<bitset<256>> charsets;
+    Vector<Node> nodes;
+    Vector<NfaState> nfa;
+    int nfaStart;
+    bool anchoredStart;
+    bool anchoredEnd;
+    string prefilter;//литерал, который обязан входить в любое совпадение
+
+    bool useDfa;
+    Vector<int> transitions;//состояние * 256 + байт -> состояние
+    Vector<bool> accepting;
+    int dfaStart;
+
+    //разбор шаблона в дерево
+    const string* pattern;
+    size_t pos;
+    string error;
+    int parseAlternation(bool topLevel = false);
+    int parseConcat();
+    int parseRepeat();
+    int parseAtom();
+    int parseClass();
+    bool parseEscape(bitset<256>& set);
+    int addNode(NodeKind kind, int charset = -1);
+    int addCharset(const bitset<256>& set);
+    int repeatNode(int child, int minCount, int maxCount);
+
+    int buildNfa(int node, int next);
+    //множества состояний НКА держим отсортированными, чтобы по ним искать состояния ДКА
+    void closure(int state, NfaScratch& scratch, std::vector<int>& states) const;
+    void step(const std::vector<int>& from, unsigned char c, std::vector<int>& to, NfaScratch& scratch) const;
+    bool containsMatch(const std::vector<int>& states) const;
+    bool buildDfa();
+    void appendRequired(int node, string& current, string& best) const;
+    bool matchNfa(const string& text) const;
+
+    RegexMatcher();
+
+public:
+    //nullptr и текст ошибки, если шаблон некорректен
+    static shared_ptr<const RegexMatcher> compile(const string& pattern, string& error);
+
+    bool matches(const string& text) const;
+    const string& getPrefilter() const { return prefilter; }
+};
+
+//скомпилированные шаблоны по тексту, общие для всех запросов
+class RegexCache {
+private:
+    HashMap<string, shared_ptr<const RegexMatcher>> patterns;
+    mutex cacheMutex;
+    static const size_t MAX_PATTERNS = 256;
+
+public:
+    static RegexCache& instance();
+    shared_ptr<const RegexMatcher> get(const string& pattern, string& error);//nullptr и текст ошибки, если шаблон некорректен
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "siem_agent.h"
 #include "db_client.h"
 #include "JsonParser.h"
+#include "json_writer.h"
+#include "json_value.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -13,6 +15,7 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #include <cstring>
+#include <climits>
 #include <regex>
 #include <cstdio>
 #include <sys/inotify.h>
@@ -23,42 +26,29 @@
 using namespace std;
 
 string SecurityEvent::toJson() const {
-    ostringstream json;
-    json << "{";
-
-    auto addField = [&json](const string& name, const string& value, bool first = false) {
-        if (!first) json << ",";
-
-        string escaped;
-        for (char c : value) {
-            switch (c) {
-                case '"':  escaped += "\\\""; break;
-                case '\\': escaped += "\\\\"; break;
-                case '\n': escaped += "\\n"; break;
-                case '\r': escaped += "\\r"; break;
-                case '\t': escaped += "\\t"; break;
-                case '\b': escaped += "\\b"; break;
-                case '\f': escaped += "\\f"; break;
-                default:   escaped += c; break;
-            }
-        }
-
-        json << "\"" << name << "\":\"" << escaped << "\"";
+    string json;
+    json.reserve(256 + raw_log.size() + command.size());
+    json += "{";
+
+    auto addField = [&json](const char* name, const string& value, bool first = false) {
+        if (!first) json += ",";
+        json += name;
+        JsonWriter::appendQuoted(json, value);
     };
 
-    addField("timestamp", timestamp, true);
-    addField("hostname", hostname);
-    addField("source", source);
-    addField("event_type", event_type);
-    addField("severity", severity);
-    addField("user", user);
-    addField("process", process);
-    addField("command", command);
-    addField("raw_log", raw_log);
-    addField("agent_id", agent_id);
-
-    json << "}";
-    return json.str();
+    addField("\"timestamp\":", timestamp, true);
+    addField("\"hostname\":", hostname);
+    addField("\"source\":", source);
+    addField("\"event_type\":", event_type);
+    addField("\"severity\":", severity);
+    addField("\"user\":", user);
+    addField("\"process\":", process);
+    addField("\"command\":", command);
+    addField("\"raw_log\":", raw_log);
+    addField("\"agent_id\":", agent_id);
+
+    json += "}";
+    return json;
 }
 
 HashMap<string, string> SecurityEvent::toHashMap() const {
@@ -100,8 +90,6 @@ AgentConfig AgentConfig::loadFromFile(const string& config_path) {
     config.max_buffer_size = 1000;
     config.persistent_buffer_path = "/var/lib/siem_agent/buffer";
 
-    JsonParser parser;
-
     ifstream config_file(config_path);
     if (config_file.is_open()) {
         cout << "Loading config from: " << config_path << endl;
@@ -110,110 +98,74 @@ AgentConfig AgentConfig::loadFromFile(const string& config_path) {
         string json_content = buffer.str();
         config_file.close();
 
-        if (!json_content.empty()) {
-            try {
-                HashMap<string, string> config_map = parser.parse(json_content);
-
-                string value;
-                if (config_map.get("server_host", value)) {
-                    config.server_host = value;
-                }
-
-                string port_str;
-                if (config_map.get("server_port", port_str)) {
-                    try {
-                        config.server_port = stoi(port_str);
-                    } catch (...) {
-                        cerr << "WARNING: Invalid port, using default: " << config.server_port << endl;
-                    }
-                }
-
-                if (config_map.get("database", value)) {
-                    config.database = value;
-                }
-
-                if (config_map.get("collection", value)) {
-                    config.collection = value;
-                }
-
-                if (config_map.get("agent_id", value)) {
-                    config.agent_id = value;
-                }
+        JsonDocument parsed;
+        bool loaded = !json_content.empty() && parsed.parse(json_content) && parsed.root().isObject();
+        if (!json_content.empty() && !loaded) {
+            cerr << "Config parse error: expected a JSON object" << endl;
+        }
+        if (loaded) {
+            JsonValue root = parsed.root();
 
-                if (config_map.get("log_file", value)) {
-                    config.log_file = value;
+            auto readText = [&root](const char* name, string& target) {
+                JsonValue value = root.get(name);
+                if (value.isString()) {
+                    target = value.str();
                 }
-
-                string interval_str;
-                if (config_map.get("send_interval", interval_str)) {
-                    try {
-                        config.send_interval = stoi(interval_str);
-                    } catch (...) {
-                        cerr << "WARNING: Invalid send_interval, using default: " << config.send_interval << endl;
-                    }
+            };
+            auto readInt = [&root](const char* name, int& target) {
+                JsonValue value = root.get(name);
+                if (!value.valid()) {
+                    return;
                 }
-
-                string batch_str;
-                if (config_map.get("batch_size", batch_str)) {
-                    try {
-                        config.batch_size = stoi(batch_str);
-                    } catch (...) {
-                        cerr << "WARNING: Invalid batch_size, using default: " << config.batch_size << endl;
-                    }
+                if (value.isNumber() && value.number() >= INT_MIN && value.number() <= INT_MAX) {
+                    target = static_cast<int>(value.number());
+                    return;
                 }
-
-                string max_buffer_str;
-                if (config_map.get("max_buffer_size", max_buffer_str)) {
+                if (value.isString()) {//число в кавычках принимается, как и раньше
                     try {
-                        config.max_buffer_size = stoi(max_buffer_str);
+                        target = stoi(value.str());
+                        return;
                     } catch (...) {
-                        cerr << "WARNING: Invalid max_buffer_size, using default: " << config.max_buffer_size << endl;
                     }
                 }
-
-                string buffer_path;
-                if (config_map.get("persistent_buffer_path", buffer_path)) {
-                    config.persistent_buffer_path = buffer_path;
-                }
-
-                string sources_str;
-                if (config_map.get("sources", sources_str)) {
-                    Vector<HashMap<string, string>> sources_array = parser.parseArray(sources_str);
-
-                    for (size_t i = 0; i < sources_array.size(); i++) {
-                        HashMap<string, string> source_map = sources_array[i];
-                        string name, path;
-
-                        if (source_map.get("name", name) && source_map.get("path", path)) {
-                            config.enabled_sources.push_back(name);
-                            config.source_paths.put(name, path);
-                        }
-                    }
+                cerr << "WARNING: Invalid " << name << ", using default: " << target << endl;
+            };
+
+            readText("server_host", config.server_host);
+            readInt("server_port", config.server_port);
+            readText("database", config.database);
+            readText("collection", config.collection);
+            readText("agent_id", config.agent_id);
+            readText("log_file", config.log_file);
+            readInt("send_interval", config.send_interval);
+            readInt("batch_size", config.batch_size);
+            readInt("max_buffer_size", config.max_buffer_size);
+            readText("persistent_buffer_path", config.persistent_buffer_path);
+
+            //массивы приходят деревом, без повторного разбора их текста
+            JsonValue sources = root.get("sources");
+            for (size_t i = 0; i < sources.size(); i++) {
+                JsonValue name = sources[i].get("name");
+                JsonValue path = sources[i].get("path");
+                if (name.isString() && path.isString()) {
+                    config.enabled_sources.push_back(name.str());
+                    config.source_paths.put(name.str(), path.str());
                 }
+            }
 
-                string exclude_str;
-                if (config_map.get("exclude_patterns", exclude_str)) {
-                    Vector<HashMap<string, string>> exclude_array = parser.parseArray(exclude_str);
-
-                    for (size_t i = 0; i < exclude_array.size(); i++) {
-                        HashMap<string, string> pattern_map = exclude_array[i];
-                        string pattern;
-
-                        if (pattern_map.get("pattern", pattern)) {
-                            config.exclude_patterns.push_back(pattern);
-                        }
-                    }
+            JsonValue excludes = root.get("exclude_patterns");
+            for (size_t i = 0; i < excludes.size(); i++) {
+                JsonValue pattern = excludes[i].isString() ? excludes[i] : excludes[i].get("pattern");
+                if (pattern.isString()) {
+                    config.exclude_patterns.push_back(pattern.str());
                 }
-
-                cout << "Config loaded successfully:" << endl;
-                cout << "  Agent ID: " << config.agent_id << endl;
-                cout << "  Server: " << config.server_host << ":" << config.server_port << endl;
-                cout << "  Database: " << config.database << "." << config.collection << endl;
-                cout << "  Sources: " << config.enabled_sources.size() << endl;
-
-            } catch (const exception& e) {
-                cerr << "Config parse error: " << e.what() << endl;
             }
+
+            cout << "Config loaded successfully:" << endl;
+            cout << "  Agent ID: " << config.agent_id << endl;
+            cout << "  Server: " << config.server_host << ":" << config.server_port << endl;
+            cout << "  Database: " << config.database << "." << config.collection << endl;
+            cout << "  Sources: " << config.enabled_sources.size() << endl;
         }
     } else {
         cerr << "WARNING: Cannot open config file '" << config_path << "', using defaults" << endl;
@@ -505,7 +457,6 @@ Vector<SecurityEvent> LogCollector::readFromSpecificPath(const string& specific_
 }
 
 bool LogCollector::savePosition() {
-    JsonParser parser;
     HashMap<string, string> position_map;
 
     // Сохраняем позиции файлов
@@ -751,7 +702,7 @@ void SIEMAgent::sendEventsToDB(const Vector<SecurityEvent>& events) {
             cout << event_json.substr(0, min(event_json.length(), 100ul)) << "..." << endl;
         }
 
-        req.data.push_back(event_json);
+        req.addRaw(event_json);
     }
 
     // Отправляем
@@ -0,0 +1,74 @@
+#include "slab_pool.h"
+#include <new>
+
+SlabPool::SlabPool() : slabCursor(nullptr), slabRemaining(0) {
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        freeLists[i] = nullptr;
+    }
+}
+
+SlabPool::~SlabPool() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+        ::operator delete(slabs[i]);
+    }
+}
+
+size_t SlabPool::classOf(size_t bytes) {
+    size_t sizeClass = 0;
+    size_t blockSize = size_t(1) << MIN_BLOCK_SHIFT;
+    while (blockSize < bytes && sizeClass < CLASS_COUNT) {
+        blockSize <<= 1;
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+void* SlabPool::allocate(size_t bytes) {
+    size_t sizeClass = classOf(bytes);
+    if (sizeClass == CLASS_COUNT) {
+        return ::operator new(bytes);
+    }
+    size_t blockSize = size_t(1) << (MIN_BLOCK_SHIFT + sizeClass);
+
+    lock_guard<mutex> lock(poolMutex);
+    FreeBlock* block = freeLists[sizeClass];
+    if (block) {
+        freeLists[sizeClass] = block->next;
+        return block;
+    }
+    if (slabRemaining < blockSize) {
+        //хвост старого сляба раздаем мелким классам, чтобы он не пропал
+        for (size_t c = sizeClass; c-- > 0;) {
+            size_t smaller = size_t(1) << (MIN_BLOCK_SHIFT + c);
+            while (slabRemaining >= smaller) {
+                FreeBlock* spare = reinterpret_cast<FreeBlock*>(slabCursor);
+                spare->next = freeLists[c];
+                freeLists[c] = spare;
+                slabCursor += smaller;
+                slabRemaining -= smaller;
+            }
+        }
+        slabCursor = static_cast<char*>(::operator new(SLAB_SIZE));
+        slabRemaining = SLAB_SIZE;
+        slabs.push_back(slabCursor);
+    }
+    void* result = slabCursor;
+    slabCursor += blockSize;
+    slabRemaining -= blockSize;
+    return result;
+}
+
+void SlabPool::deallocate(void* block, size_t bytes) {
+    if (!block) {
+        return;
+    }
+    size_t sizeClass = classOf(bytes);
+    if (sizeClass == CLASS_COUNT) {
+        ::operator delete(block);
+        return;
+    }
+    lock_guard<mutex> lock(poolMutex);
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = freeLists[sizeClass];
+    freeLists[sizeClass] = freed;
+}
@@ -0,0 +1,50 @@
+#ifndef SLAB_POOL_H
+#define SLAB_POOL_H
+
+#include "vector.h"
+#include <cstddef>
+#include <mutex>
+using namespace std;
+
+//пул блоков по классам размеров (64, 128, ... 4096 байт), нарезанных из больших слябов.
+//освобожденный блок идет в список своего класса и достается следующей вставке;
+//все слябы отдаются системе разом вместе с пулом, то есть с коллекцией
+class SlabPool {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static const size_t MIN_BLOCK_SHIFT = 6;//64 байта
+    static const size_t CLASS_COUNT = 7;//до 4096 байт, крупнее - напрямую из кучи
+    static const size_t SLAB_SIZE = 256 * 1024;
+
+    FreeBlock* freeLists[CLASS_COUNT];
+    Vector<char*> slabs;
+    char* slabCursor;//неразмеченный остаток текущего сляба
+    size_t slabRemaining;
+    mutex poolMutex;
+
+    static size_t classOf(size_t bytes);//CLASS_COUNT если блок слишком большой
+
+public:
+    SlabPool();
+    ~SlabPool();
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    void* allocate(size_t bytes);
+    void deallocate(void* block, size_t bytes);//bytes - тот же размер, что при allocate
+
+    template<typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count));//без конструкторов
+    }
+
+    template<typename T>
+    void deallocateArray(T* array, size_t count) {
+        deallocate(array, sizeof(T) * count);
+    }
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "string_hash.h"
+#include <cstring>
+#include <ctime>
+#include <random>
+
+static const uint64_t PRIME0 = 0xa0761d6478bd642fULL;
+static const uint64_t PRIME1 = 0xe7037ed1a0b428dbULL;
+static const uint64_t PRIME2 = 0x8ebc6af09c88c6e3ULL;
+static const uint64_t PRIME3 = 0x589965cc75374cc3ULL;
+
+//полное 128-битное произведение, сложенное в 64 бита
+static inline uint64_t mix(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t aHigh = a >> 32, aLow = a & 0xFFFFFFFFULL;
+    uint64_t bHigh = b >> 32, bLow = b & 0xFFFFFFFFULL;
+    uint64_t lowLow = aLow * bLow, highLow = aHigh * bLow;
+    uint64_t lowHigh = aLow * bHigh, highHigh = aHigh * bHigh;
+    uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + lowHigh;
+    uint64_t low = (middle << 32) | (lowLow & 0xFFFFFFFFULL);
+    uint64_t high = highHigh + (highLow >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+//невыровненное чтение, порядок байт не важен: хэш живет только внутри процесса
+static inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t read32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t StringHash::hash(const char* data, size_t length, uint64_t seed) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    seed ^= mix(seed ^ PRIME0, PRIME1);
+    uint64_t a, b;
+    if (length <= 16) {
+        if (length >= 4) {//два перекрывающихся 8-байтных окна из 4-байтных чтений
+            size_t shift = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + shift);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+        } else if (length > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t remaining = length;
+        if (remaining > 48) {//три независимые цепочки, чтобы умножения шли параллельно
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = mix(read64(p) ^ PRIME1, read64(p + 8) ^ seed);
+                seed1 = mix(read64(p + 16) ^ PRIME2, read64(p + 24) ^ seed1);
+                seed2 = mix(read64(p + 32) ^ PRIME3, read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (remaining > 16) {
+            seed = mix(read64(p) ^ PRIME1, read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        a = read64(p + remaining - 16);//последние 16 байт, возможно с перекрытием
+        b = read64(p + remaining - 8);
+    }
+    return mix(PRIME1 ^ length, mix(a ^ PRIME1, b ^ seed));
+}
+
+uint64_t StringHash::processSeed() {
+    static const uint64_t seed = [] {
+        uint64_t value = static_cast<uint64_t>(time(nullptr)) ^ reinterpret_cast<uintptr_t>(&value);
+        try {
+            random_device device;
+            value ^= (static_cast<uint64_t>(device()) << 32) | device();
+        } catch (...) {
+            //без источника энтропии остаются время и адрес стека
+        }
+        return mix(value ^ PRIME2, PRIME3);
+    }();
+    return seed;
+}
+
+uint64_t StringHash::hash(const char* data, size_t length) {
+    return hash(data, length, processSeed());
+}
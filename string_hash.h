@@ -0,0 +1,18 @@
+#ifndef STRING_HASH_H
+#define STRING_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+using namespace std;
+
+//хэш строк по 8-16 байт за шаг (схема wyhash) с зерном, случайным для каждого процесса:
+//подобрать коллизии по содержимому логов заранее нельзя, порядок обхода HashMap
+//между запусками тоже другой
+class StringHash {
+public:
+    static uint64_t hash(const char* data, size_t length);//с зерном процесса
+    static uint64_t hash(const char* data, size_t length, uint64_t seed);
+    static uint64_t processSeed();
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "regex_matcher.h"
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+static double compileMs(const string& pattern, shared_ptr<const RegexMatcher>& matcher, string& error) {
+    auto start = chrono::steady_clock::now();
+    matcher = RegexMatcher::compile(pattern, error);
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    //шаблон от клиента не должен занимать сервер на секунды: ДКА строится в пределах бюджета,
+    //дальше сопоставление идет по НКА
+    const char* heavy[] = {
+        "[a-z]{0,1000}q[0-9]{0,1000}",
+        "[a-z]{0,300}q[0-9]{0,300}",
+        "(a|b)*a(a|b){12}c",
+    };
+    for (const char* pattern : heavy) {
+        shared_ptr<const RegexMatcher> matcher;
+        string error;
+        double ms = compileMs(pattern, matcher, error);
+        check(matcher != nullptr, string("compile ") + pattern + ": " + error);
+        check(ms < 500, string("compile time of ") + pattern + ": " + to_string(ms) + " ms");
+    }
+
+    shared_ptr<const RegexMatcher> matcher;
+    string error;
+    compileMs("[a-z]{0,1000}q[0-9]{0,1000}", matcher, error);
+    if (matcher) {
+        check(matcher->matches("xxq12"), "NFA match");
+        check(!matcher->matches("XXQ12"), "NFA mismatch");
+    }
+    compileMs("(a|b)*a(a|b){12}c", matcher, error);
+    if (matcher) {
+        check(matcher->matches("bbba" + string(12, 'b') + "c"), "NFA match past DFA state limit");
+        check(!matcher->matches("bbba" + string(13, 'b') + "c"), "NFA mismatch past DFA state limit");
+    }
+
+    //счетчик повторов больше MAX_REPEAT - ошибка, сколько бы в нем ни было цифр
+    const char* tooMany[] = {"a{1001}", "a{99999}", "a{2,99999999999}", "a{99999999999,}"};
+    for (const char* pattern : tooMany) {
+        check(!RegexMatcher::compile(pattern, error) && error == "invalid repetition count",
+              string("reject ") + pattern);
+    }
+    check(RegexMatcher::compile("a{1000}", error) != nullptr, "a{1000} compiles");
+    matcher = RegexMatcher::compile("a{x}", error);
+    check(matcher && matcher->matches("a{x}"), "'{' without digits is a literal");
+
+    if (failures == 0) {
+        cout << "test_regex_matcher: OK" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
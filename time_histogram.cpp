@@ -0,0 +1,169 @@
+#include "time_histogram.h"
+#include "json_writer.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+
+TimeHistogram::TimeHistogram(int64_t interval)
+    : interval(interval), skipped(0), overflowed(false) {}
+
+bool TimeHistogram::parseInterval(const string& text, int64_t& seconds) {
+    if (text.empty()) {
+        return false;
+    }
+    size_t pos = 0;
+    int64_t number = 0;
+    while (pos < text.size() && isdigit(static_cast<unsigned char>(text[pos]))) {
+        number = number * 10 + (text[pos] - '0');
+        if (number > MAX_INTERVAL) return false;
+        pos++;
+    }
+    if (pos == 0) {
+        return false;
+    }
+    int64_t unit = 1;
+    if (pos < text.size()) {
+        if (pos + 1 != text.size()) return false;
+        switch (text[pos]) {
+            case 's': unit = 1; break;
+            case 'm': unit = 60; break;
+            case 'h': unit = 3600; break;
+            case 'd': unit = 86400; break;
+            default: return false;
+        }
+    }
+    seconds = number * unit;
+    return seconds >= MIN_INTERVAL && seconds <= MAX_INTERVAL;
+}
+
+//дни от 1970-01-01 для григорианской даты (алгоритм Хиннанта), без timegm и локали
+static int64_t daysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static bool readDigits(const string& text, size_t pos, size_t count, int64_t& value) {
+    if (pos + count > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = pos; i < pos + count; i++) {
+        if (!isdigit(static_cast<unsigned char>(text[i]))) return false;
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+bool TimeHistogram::parseTimestamp(const string& text, int64_t& epochSeconds) {
+    int64_t year, month, day, hour, minute, second;
+    if (!readDigits(text, 0, 4, year) || text.size() < 19 || text[4] != '-' ||
+        !readDigits(text, 5, 2, month) || text[7] != '-' || !readDigits(text, 8, 2, day) ||
+        (text[10] != 'T' && text[10] != ' ') || !readDigits(text, 11, 2, hour) || text[13] != ':' ||
+        !readDigits(text, 14, 2, minute) || text[16] != ':' || !readDigits(text, 17, 2, second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    size_t pos = 19;
+    if (pos < text.size() && text[pos] == '.') {//доли секунды в интервалы не влияют
+        pos++;
+        while (pos < text.size() && isdigit(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+    int64_t offset = 0;
+    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+        int64_t offsetHours, offsetMinutes;
+        size_t minutesPos = text.size() > pos + 3 && text[pos + 3] == ':' ? pos + 4 : pos + 3;
+        if (!readDigits(text, pos + 1, 2, offsetHours) || !readDigits(text, minutesPos, 2, offsetMinutes)) {
+            return false;
+        }
+        offset = (offsetHours * 3600 + offsetMinutes * 60) * (text[pos] == '+' ? 1 : -1);
+        pos = minutesPos + 2;
+    } else if (pos < text.size() && text[pos] == 'Z') {
+        pos++;
+    }
+    if (pos != text.size()) {
+        return false;
+    }
+
+    epochSeconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+    return true;
+}
+
+string TimeHistogram::formatTimestamp(int64_t epochSeconds) {
+    int64_t days = epochSeconds >= 0 ? epochSeconds / 86400 : (epochSeconds - 86399) / 86400;
+    int64_t secondsOfDay = epochSeconds - days * 86400;
+
+    //обратное преобразование к daysFromCivil
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t dayOfEra = z - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t mp = (5 * dayOfYear + 2) / 153;
+    int64_t day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = yearOfEra + era * 400 + (month <= 2);
+
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%04lld-%02lld-%02lldT%02lld:%02lld:%02lldZ",
+             static_cast<long long>(year), static_cast<long long>(month), static_cast<long long>(day),
+             static_cast<long long>(secondsOfDay / 3600), static_cast<long long>(secondsOfDay / 60 % 60),
+             static_cast<long long>(secondsOfDay % 60));
+    return string(buffer);
+}
+
+void TimeHistogram::add(const string& timestamp, const string* splitValue) {
+    int64_t seconds = 0;
+    if (!parseTimestamp(timestamp, seconds)) {
+        skipped++;
+        return;
+    }
+    int64_t start = seconds / interval * interval;
+    if (seconds < 0 && seconds % interval != 0) {
+        start -= interval;//округление вниз и для времени до 1970
+    }
+
+    auto found = buckets.find(start);
+    if (found == buckets.end()) {
+        if (buckets.size() >= MAX_BUCKETS) {
+            overflowed = true;
+            return;
+        }
+        found = buckets.insert(make_pair(start, Bucket())).first;
+    }
+    found->second.count++;
+    if (splitValue) {
+        found->second.bySplit[*splitValue]++;
+    }
+}
+
+Vector<string> TimeHistogram::toJsonRows() const {
+    Vector<string> rows;
+    string row;
+    for (auto it = buckets.begin(); it != buckets.end(); ++it) {
+        row = "{\"bucket\":\"" + formatTimestamp(it->first) + "\",\"start\":";
+        JsonWriter::appendInteger(row, it->first);
+        row += ",\"count\":";
+        JsonWriter::appendInteger(row, it->second.count);
+        if (!it->second.bySplit.empty()) {
+            row += ",\"by\":{";
+            bool first = true;
+            for (auto split = it->second.bySplit.begin(); split != it->second.bySplit.end(); ++split) {
+                if (!first) row += ",";
+                first = false;
+                JsonWriter::appendKey(row, split->first);
+                JsonWriter::appendInteger(row, split->second);
+            }
+            row += "}";
+        }
+        row += "}";
+        rows.push_back(row);
+    }
+    return rows;
+}
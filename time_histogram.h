@@ -0,0 +1,44 @@
+#ifndef TIME_HISTOGRAM_H
+#define TIME_HISTOGRAM_H
+
+#include "vector.h"
+#include <string>
+#include <map>
+#include <cstdint>
+using namespace std;
+
+//число событий по интервалам времени, опционально с разбивкой по значению поля
+class TimeHistogram {
+private:
+    struct Bucket {
+        uint64_t count;
+        map<string, uint64_t> bySplit;
+        Bucket() : count(0) {}
+    };
+
+    map<int64_t, Bucket> buckets;//начало интервала (секунды UTC) -> счетчики
+    int64_t interval;
+    size_t skipped;//значения, которые не удалось разобрать как время
+    bool overflowed;
+
+public:
+    static const int64_t MIN_INTERVAL = 1;
+    static const int64_t MAX_INTERVAL = 86400;
+    static const size_t MAX_BUCKETS = 100000;
+
+    explicit TimeHistogram(int64_t interval);
+
+    //"30s", "5m", "1h", "1d" или число секунд
+    static bool parseInterval(const string& text, int64_t& seconds);
+    //YYYY-MM-DDTHH:MM:SS[.fff][Z|+HH:MM], как пишет EventProcessor::normalizeTimestamp
+    static bool parseTimestamp(const string& text, int64_t& epochSeconds);
+    static string formatTimestamp(int64_t epochSeconds);
+
+    void add(const string& timestamp, const string* splitValue);
+    bool isOverflowed() const { return overflowed; }
+    size_t bucketCount() const { return buckets.size(); }
+    size_t skippedCount() const { return skipped; }
+    Vector<string> toJsonRows() const;//по возрастанию времени
+};
+
+#endif
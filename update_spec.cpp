@@ -0,0 +1,56 @@
+#include "update_spec.h"
+#include "json_value.h"
+
+bool UpdateSpec::empty() const {
+    return setFields.size() == 0 && incFields.size() == 0 && unsetFields.empty();
+}
+
+bool UpdateSpec::parse(const string& json, UpdateSpec& spec, string& error) {
+    JsonDocument parsed;
+    JsonValue modifiers;
+    if (parsed.parse(json) && parsed.root().isObject()) {
+        modifiers = parsed.root();
+    }
+    for (size_t i = 0; i < modifiers.size(); i++) {
+        JsonValue body = modifiers[i];
+        string op = body.name().str();
+        if (!body.isObject()) {
+            error = "Modifier " + op + " expects an object";
+            return false;
+        }
+
+        for (size_t j = 0; j < body.size(); j++) {
+            JsonValue entry = body[j];
+            string field = entry.name().str();
+            if (field == "_id") {//идентификатор не меняется
+                continue;
+            }
+            JsonSpan text = entry.text();
+            string value = text.str();
+            if (op == "$set") {//как при вставке: невалидный контейнер становится строкой
+                spec.setFields.put(field, value);
+                spec.setContainers.put(field, (entry.isObject() || entry.isArray()) &&
+                                              JsonTokenizer::isValid(text.data, text.length));
+            } else if (op == "$inc") {
+                try {
+                    stod(value);
+                } catch (...) {
+                    error = "$inc value for " + field + " is not a number";
+                    return false;
+                }
+                spec.incFields.put(field, value);
+            } else if (op == "$unset") {
+                spec.unsetFields.push_back(field);
+            } else {
+                error = "Unknown update modifier: " + op;
+                return false;
+            }
+        }
+    }
+
+    if (spec.empty()) {
+        error = "Update requires $set, $inc or $unset";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef UPDATE_SPEC_H
+#define UPDATE_SPEC_H
+
+#include "HashMap.h"
+#include "vector.h"
+#include <string>
+using namespace std;
+
+//модификаторы операции update: {"$set":{...},"$inc":{...},"$unset":{...}}
+struct UpdateSpec {
+    HashMap<string, string> setFields;
+    HashMap<string, bool> setContainers;//поле $set -> значение объект или массив
+    HashMap<string, string> incFields;//поле -> приращение
+    Vector<string> unsetFields;
+
+    bool empty() const;
+    static bool parse(const string& json, UpdateSpec& spec, string& error);
+};
+
+#endif
@@ -2,15 +2,21 @@
 #define VECTOR_H
 
 #include <string>
+#include <cstddef>
 using namespace std;
 
 template<typename T>
 class Vector {
 private:
-    T* data;
+    T* data;//сырая память: живы только первые sizeVal элементов
     size_t capacity;
     size_t sizeVal;
 
+    static T* allocate(size_t count);
+    static void deallocate(T* storage);
+    void reallocate(size_t newCapacity);//перемещает элементы в новый буфер
+    size_t grownCapacity() const;
+
 public:
     Vector();
     ~Vector();
@@ -20,6 +26,11 @@ public:
     Vector& operator=(Vector&& other) noexcept;//операторп рисваивания перемещением
     void push_back(const T& value);
     void push_back(T&& value);  // новая перегрузка для перемещения
+    template<typename... Args>
+    T& emplace_back(Args&&... args);//создает элемент прямо в буфере
+    void reserve(size_t newCapacity);
+    void erase(size_t first, size_t last);//удаляет [first, last), хвост сдвигается
+    void shrink_to_fit();
     void pop_back();  // новый метод
     T& back();  // новый метод
     const T& back() const;  // новый метод
@@ -27,7 +38,7 @@ public:
     const T& operator[](size_t index) const;
     size_t size() const;
     bool empty() const;
-    void clear();
+    void clear();//память остается для повторного заполнения
 
     class Iterator {
     private: